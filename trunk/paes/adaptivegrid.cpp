@@ -0,0 +1,185 @@
+#include "adaptivegrid.hpp"
+#include <sstream>
+#include <bitset>
+#include <stdexcept>
+#include <taintedstateexception.hpp>
+#include <random.hpp>
+
+using namespace scheduler;
+
+// Both dimensions must fit into one cell id.
+typedef char LocationSizeCheck[(2 * config::LOCATION_DIMENSION_SIZE <= 64) ? 1 : -1];
+
+AdaptiveGrid::AdaptiveGrid (const unsigned int bits) :
+  _bits(bits),
+  _minQueueTime(0.0), _maxQueueTime(0.0), _minPrice(0.0), _maxPrice(0.0),
+  _cells(), _buckets(1), _maxPopulation(0)
+{
+  if (bits == 0 || 2 * bits > 64)
+	throw std::invalid_argument("AdaptiveGrid: the number of bits per dimension must be in [1; 32].");
+}
+
+bool AdaptiveGrid::setBounds(const double& minQueueTime, const double& maxQueueTime,
+	const double& minPrice, const double& maxPrice) {
+  if (minQueueTime == _minQueueTime && maxQueueTime == _maxQueueTime &&
+	  minPrice == _minPrice && maxPrice == _maxPrice)
+	return false;
+  _minQueueTime=minQueueTime;
+  _maxQueueTime=maxQueueTime;
+  _minPrice=minPrice;
+  _maxPrice=maxPrice;
+  return true;
+}
+
+inline AdaptiveGrid::CellType AdaptiveGrid::locateDimension(
+	const double& current, const double& min, const double& max,
+	const unsigned int bits) {
+  if ((current < min) || (current > max))
+	throw TaintedStateException("Tainted: current value is not in the [min; max]-Interval.");
+  double lBound = min;
+  double uBound = max;
+  CellType location = 0;
+  for( unsigned int i = 0; i < bits; i += 1) {
+	location <<= 1;
+	double center=lBound + ((uBound - lBound) / 2.0);
+	if (current >= center) {
+	  location |= 1;
+	  lBound=center;
+	} else {
+	  uBound=center;
+	}
+  }
+  return location;
+}
+
+// With a constant number of bits, the compiler unrolls the bisection.
+template <unsigned int BITS>
+inline AdaptiveGrid::CellType AdaptiveGrid::locateFixed(const double& queueTime, const double& price) const {
+  return (locateDimension(price, _minPrice, _maxPrice, BITS) << BITS) |
+	locateDimension(queueTime, _minQueueTime, _maxQueueTime, BITS);
+}
+
+AdaptiveGrid::CellType AdaptiveGrid::locate(const double& queueTime, const double& price) const {
+  switch (_bits) {
+	case 32: return locateFixed<32>(queueTime, price);
+	case 16: return locateFixed<16>(queueTime, price);
+	case 8: return locateFixed<8>(queueTime, price);
+	default:
+	  return (locateDimension(price, _minPrice, _maxPrice, _bits) << _bits) |
+		locateDimension(queueTime, _minQueueTime, _maxQueueTime, _bits);
+  }
+}
+
+void AdaptiveGrid::add(const scheduler::Schedule::Ptr& schedule) {
+  CellType cell=locate(schedule->getTotalQueueTime(), schedule->getTotalPrice());
+  schedule->setLocation(cell);
+  Cell& entry=_cells[cell];
+  if (! entry.members.empty())
+	removeFromBucket(cell, entry);
+  entry.members.push_back(schedule);
+  addToBucket(cell, entry);
+}
+
+void AdaptiveGrid::remove(const scheduler::Schedule::Ptr& schedule) {
+  CellMapType::iterator it=_cells.find(schedule->getLocation());
+  if (it == _cells.end())
+	return;
+  Cell& entry=(*it).second;
+  std::vector<scheduler::Schedule::Ptr>& members=entry.members;
+  for (size_t i=0; i < members.size(); i++) {
+	if (members[i] == schedule) {
+	  removeFromBucket((*it).first, entry);
+	  members[i]=members.back();
+	  members.pop_back();
+	  if (members.empty())
+		_cells.erase(it);
+	  else
+		addToBucket((*it).first, entry);
+	  return;
+	}
+  }
+}
+
+void AdaptiveGrid::clear() {
+  _cells.clear();
+  for (size_t i=0; i < _buckets.size(); i++)
+	_buckets[i].clear();
+  _maxPopulation=0;
+}
+
+const AdaptiveGrid::LayoutType AdaptiveGrid::getLayout() const {
+  LayoutType retval;
+  retval.reserve(_cells.size());
+  for (size_t population=1; population < _buckets.size(); population++) {
+	for (size_t i=0; i < _buckets[population].size(); i++) {
+	  CellLayout entry;
+	  entry.cell=_buckets[population][i];
+	  entry.members=(*_cells.find(entry.cell)).second.members;
+	  retval.push_back(entry);
+	}
+  }
+  return retval;
+}
+
+void AdaptiveGrid::setLayout(const LayoutType& layout) {
+  clear();
+  // the cells come in bucket order, so appending rebuilds the buckets
+  for (size_t i=0; i < layout.size(); i++) {
+	Cell& entry=_cells[layout[i].cell];
+	entry.members=layout[i].members;
+	for (size_t j=0; j < entry.members.size(); j++)
+	  entry.members[j]->setLocation(layout[i].cell);
+	addToBucket(layout[i].cell, entry);
+  }
+}
+
+void AdaptiveGrid::addToBucket(const CellType& cell, Cell& entry) {
+  size_t population=entry.members.size();
+  if (population >= _buckets.size())
+	_buckets.resize(population + 1);
+  entry.bucketIndex=_buckets[population].size();
+  _buckets[population].push_back(cell);
+  if (population > _maxPopulation)
+	_maxPopulation=population;
+}
+
+void AdaptiveGrid::removeFromBucket(const CellType& cell, Cell& entry) {
+  std::vector<CellType>& bucket=_buckets[entry.members.size()];
+  // move the last cell of the bucket into the gap
+  CellType last=bucket.back();
+  bucket[entry.bucketIndex]=last;
+  if (last != cell)
+	_cells[last].bucketIndex=entry.bucketIndex;
+  bucket.pop_back();
+  while (_maxPopulation > 0 && _buckets[_maxPopulation].empty())
+	_maxPopulation--;
+}
+
+unsigned long AdaptiveGrid::getPopulation(const CellType& cell) const {
+  CellMapType::const_iterator it=_cells.find(cell);
+  if (it == _cells.end())
+	return 0;
+  return (*it).second.members.size();
+}
+
+scheduler::Schedule::Ptr AdaptiveGrid::getRandomCrowdedSchedule() const {
+  if (_maxPopulation == 0)
+	return scheduler::Schedule::Ptr();
+  // All crowded cells have _maxPopulation members, so one draw over all
+  // of their members picks the cell and the member, as the old scan did.
+  util::RNG& rng=util::RNG::instance();
+  const std::vector<CellType>& crowded=_buckets[_maxPopulation];
+  unsigned long draw=rng.uniform_derivate_ranged_int(0, crowded.size() * _maxPopulation - 1);
+  CellType cell=crowded[draw / _maxPopulation];
+  const std::vector<scheduler::Schedule::Ptr>& members=(*_cells.find(cell)).second.members;
+  return members[draw % _maxPopulation];
+}
+
+const std::string AdaptiveGrid::str() const {
+  std::ostringstream oss;
+  oss << "location -> count" << std::endl;
+  CellMapType::const_iterator it;
+  for ( it=_cells.begin() ; it != _cells.end(); it++ )
+	oss << std::bitset<64>((*it).first).to_string().substr(64 - 2 * _bits) << " -> " << (*it).second.members.size() << std::endl;
+  return oss.str();
+}
@@ -0,0 +1,105 @@
+#ifndef PAES_ADAPTIVEGRID_HPP
+#define PAES_ADAPTIVEGRID_HPP 1
+
+#include <common.hpp>
+#include <config.hpp>
+#include <schedule.hpp>
+#include <vector>
+#include <tr1/unordered_map>
+
+namespace scheduler {
+  /**
+   * The adaptive grid of PAES: the objective space between the bounds
+   * of the archive is divided into 2^bits slices per objective, with at
+   * most 32 bits. A cell is identified by an integer, the price bits
+   * followed by the queue time bits. The bisection is unrolled for the
+   * common resolutions of 8, 16 and 32 bits, other values take a loop.
+   *
+   * The grid counts the archived schedules per cell and keeps the cells
+   * in buckets by population, so the most crowded cells are known
+   * without scanning. Adding or removing a schedule touches its cell
+   * only. When the bounds change, all locations are recomputed.
+   */
+  class AdaptiveGrid {
+	public:
+	  typedef scheduler::Schedule::LocationType CellType;
+	  /**
+	   * A cell and its members, in the order the grid keeps them.
+	   */
+	  struct CellLayout {
+		CellType cell;
+		std::vector<scheduler::Schedule::Ptr> members;
+	  };
+	  typedef std::vector<CellLayout> LayoutType;
+	  AdaptiveGrid (const unsigned int bits = config::LOCATION_DIMENSION_SIZE);
+	  virtual ~AdaptiveGrid() {};
+	  /**
+	   * Sets the bounds of the grid. Returns true if they changed - the
+	   * caller then has to rebuild the grid.
+	   */
+	  bool setBounds(const double& minQueueTime, const double& maxQueueTime,
+		  const double& minPrice, const double& maxPrice);
+	  /**
+	   * Returns the cell of a point, which must be within the bounds.
+	   */
+	  CellType locate(const double& queueTime, const double& price) const;
+	  /**
+	   * Sets the location of the schedule and counts it in its cell.
+	   */
+	  void add(const scheduler::Schedule::Ptr& schedule);
+	  /**
+	   * Removes the schedule from the cell it was added to.
+	   */
+	  void remove(const scheduler::Schedule::Ptr& schedule);
+	  void clear();
+	  /**
+	   * Returns all cells, ordered by population and by their position
+	   * in the bucket of that population. The order of the cells and
+	   * members decides which schedule getRandomCrowdedSchedule() draws.
+	   */
+	  const LayoutType getLayout() const;
+	  /**
+	   * Replaces the content of the grid by a layout returned by
+	   * getLayout() and sets the locations of the members. The bounds
+	   * must be the ones of the grid the layout was taken from.
+	   */
+	  void setLayout(const LayoutType& layout);
+	  unsigned long getPopulation(const CellType& cell) const;
+	  unsigned long getMaxPopulation() const { return _maxPopulation; };
+	  unsigned int getBits() const { return _bits; };
+	  /**
+	   * Returns one of the schedules in the most crowded cells, all with
+	   * the same probability and from a single random number, or an
+	   * empty pointer if the grid is empty.
+	   */
+	  scheduler::Schedule::Ptr getRandomCrowdedSchedule() const;
+	  const std::string str() const;
+
+	private:
+	  struct Cell {
+		std::vector<scheduler::Schedule::Ptr> members;
+		// position of the cell in the bucket of its population
+		size_t bucketIndex;
+	  };
+	  typedef std::tr1::unordered_map<CellType, Cell> CellMapType;
+	  AdaptiveGrid (const AdaptiveGrid& original);
+	  AdaptiveGrid& operator= (const AdaptiveGrid& rhs);
+	  static CellType locateDimension(const double& current, const double& min,
+		  const double& max, const unsigned int bits);
+	  template <unsigned int BITS>
+	  CellType locateFixed(const double& queueTime, const double& price) const;
+	  void addToBucket(const CellType& cell, Cell& entry);
+	  void removeFromBucket(const CellType& cell, Cell& entry);
+	  unsigned int _bits;
+	  double _minQueueTime;
+	  double _maxQueueTime;
+	  double _minPrice;
+	  double _maxPrice;
+	  CellMapType _cells;
+	  // _buckets[n] lists the cells with n schedules
+	  std::vector<std::vector<CellType> > _buckets;
+	  unsigned long _maxPopulation;
+  };
+}
+
+#endif /* PAES_ADAPTIVEGRID_HPP */
@@ -29,6 +29,7 @@ namespace scheduler {
       void setQueueTime(const double& queueTime) { _queueTime=queueTime; };
       const double getFinishTime() { return _finishTime; };
       void setFinishTime(const double& finishTime) { _finishTime=finishTime; };
+      double getPrice() { return _price; };
 
       const std::string str() const;
       
@@ -0,0 +1,82 @@
+#include "assignmenttree.hpp"
+#include <algorithm>
+
+using namespace scheduler;
+
+const size_t AssignmentTree::LEAF_SIZE;
+const size_t AssignmentTree::INNER_SIZE;
+
+AssignmentTree::AssignmentTree (const ListType& values) :
+  _root(),
+  _size(values.size()),
+  _depth(0)
+{
+  if (values.empty())
+	return;
+  std::vector<NodePtr> level;
+  for (size_t first = 0; first < values.size(); first += LEAF_SIZE) {
+	Leaf* leaf=new Leaf();
+	size_t count=std::min(LEAF_SIZE, values.size() - first);
+	std::copy(values.begin() + first, values.begin() + first + count, leaf->values);
+	level.push_back(NodePtr(leaf));
+  }
+  while (level.size() > 1) {
+	std::vector<NodePtr> parents;
+	for (size_t first = 0; first < level.size(); first += INNER_SIZE) {
+	  Inner* inner=new Inner();
+	  size_t count=std::min(INNER_SIZE, level.size() - first);
+	  std::copy(level.begin() + first, level.begin() + first + count, inner->children);
+	  parents.push_back(NodePtr(inner));
+	}
+	level.swap(parents);
+	_depth++;
+  }
+  _root=level[0];
+}
+
+AssignmentTree::ValueType AssignmentTree::get(const size_t index) const {
+  const size_t leafIndex=index >> LEAF_BITS;
+  const void* node=_root.get();
+  for (unsigned int level = _depth; level > 0; level--) {
+	size_t child=(leafIndex >> (INNER_BITS * (level - 1))) & (INNER_SIZE - 1);
+	node=static_cast<const Inner*>(node)->children[child].get();
+  }
+  return static_cast<const Leaf*>(node)->values[index & (LEAF_SIZE - 1)];
+}
+
+/**
+ * Replaces the nodes on the path to the job with modified copies - the
+ * originals may still be referenced by other assignments.
+ */
+void AssignmentTree::set(const size_t index, const ValueType& value) {
+  const size_t leafIndex=index >> LEAF_BITS;
+  NodePtr* node=&_root;
+  for (unsigned int level = _depth; level > 0; level--) {
+	Inner* copy=new Inner(*static_cast<const Inner*>(node->get()));
+	*node=NodePtr(copy);
+	node=&copy->children[(leafIndex >> (INNER_BITS * (level - 1))) & (INNER_SIZE - 1)];
+  }
+  Leaf* copy=new Leaf(*static_cast<const Leaf*>(node->get()));
+  *node=NodePtr(copy);
+  copy->values[index & (LEAF_SIZE - 1)]=value;
+}
+
+AssignmentTree::ListType AssignmentTree::getValues() const {
+  ListType values;
+  values.reserve(_size);
+  if (_root)
+	append(_root, _depth, values);
+  return values;
+}
+
+void AssignmentTree::append(const NodePtr& node, const unsigned int level, ListType& values) const {
+  if (level == 0) {
+	const Leaf* leaf=static_cast<const Leaf*>(node.get());
+	size_t count=std::min(LEAF_SIZE, _size - values.size());
+	values.insert(values.end(), leaf->values, leaf->values + count);
+	return;
+  }
+  const Inner* inner=static_cast<const Inner*>(node.get());
+  for (size_t i = 0; i < INNER_SIZE && inner->children[i]; i++)
+	append(inner->children[i], level - 1, values);
+}
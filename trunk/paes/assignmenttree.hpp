@@ -0,0 +1,55 @@
+#ifndef PAES_ASSIGNMENTTREE_HPP
+#define PAES_ASSIGNMENTTREE_HPP 1
+
+#include <common.hpp>
+#include <resource.hpp>
+#include <vector>
+
+namespace scheduler {
+  /**
+   * The resource of each job of a schedule, by job index. Copies share
+   * their nodes, so copying the assignment for a mutant costs the same
+   * whatever the number of jobs.
+   *
+   * The values are kept in leaves of LEAF_SIZE jobs below a tree of
+   * inner nodes with INNER_SIZE children. Nodes are never modified once
+   * they are shared: set() copies the leaf of the job and the inner
+   * nodes above it, O(LEAF_SIZE + INNER_SIZE log n), and leaves all
+   * other copies as they were. get() descends the tree in O(log n).
+   */
+  class AssignmentTree {
+	public:
+	  typedef scheduler::Resource::IDType ValueType;
+	  typedef std::vector<ValueType> ListType;
+	  static const unsigned int LEAF_BITS = 8;
+	  static const unsigned int INNER_BITS = 5;
+	  AssignmentTree () : _root(), _size(0), _depth(0) {};
+	  explicit AssignmentTree (const ListType& values);
+	  virtual ~AssignmentTree() {};
+	  size_t size() const { return _size; };
+	  ValueType get(const size_t index) const;
+	  void set(const size_t index, const ValueType& value);
+	  /**
+	   * Returns the values of all jobs in job index order.
+	   */
+	  ListType getValues() const;
+
+	private:
+	  typedef std::tr1::shared_ptr<void> NodePtr;
+	  static const size_t LEAF_SIZE = 1 << LEAF_BITS;
+	  static const size_t INNER_SIZE = 1 << INNER_BITS;
+	  struct Leaf {
+		ValueType values[LEAF_SIZE];
+	  };
+	  struct Inner {
+		NodePtr children[INNER_SIZE];
+	  };
+	  void append(const NodePtr& node, const unsigned int level, ListType& values) const;
+	  NodePtr _root;
+	  size_t _size;
+	  // number of inner node levels above the leaves
+	  unsigned int _depth;
+  };
+}
+
+#endif /* PAES_ASSIGNMENTTREE_HPP */
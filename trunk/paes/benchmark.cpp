@@ -0,0 +1,428 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <new>
+#include <unistd.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include <common.hpp>
+#include <config.hpp>
+#include <random.hpp>
+#include <workload.hpp>
+#include <workload-factory.hpp>
+#include <binaryworkloadfile.hpp>
+#include <resourcepool.hpp>
+#include <simpleresource.hpp>
+#include <linearpricing.hpp>
+#include <schedule.hpp>
+#include <schedulearchive.hpp>
+
+/*
+ * Microbenchmarks of the evaluation engine on synthetic workloads. Each
+ * benchmark repeats its operation until it ran for the minimal time and
+ * reports the time and the number of heap allocations per operation.
+ */
+
+static volatile unsigned long allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  __sync_fetch_and_add(&allocations, 1);
+  void* p=malloc(size > 0 ? size : 1);
+  if (p == NULL)
+	throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+inline double getSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * One operation to time. setUp() is not timed.
+ */
+class Benchmark {
+  public:
+	Benchmark (const std::string& name) : _name(name) {};
+	virtual ~Benchmark() {};
+	const std::string& getName() const { return _name; };
+	virtual void setUp() {};
+	virtual void op() = 0;
+  private:
+	Benchmark (const Benchmark& original);
+	Benchmark& operator= (const Benchmark& rhs);
+	std::string _name;
+};
+
+struct Result {
+  std::string name;
+  size_t jobs;
+  size_t resources;
+  unsigned long ops;
+  double seconds;
+  unsigned long allocations;
+};
+
+/**
+ * Doubles the number of operations until they take at least minSeconds.
+ */
+Result measure(Benchmark& benchmark, const size_t jobs, const size_t resources,
+	const double minSeconds) {
+  benchmark.setUp();
+  // warm up
+  benchmark.op();
+  Result result;
+  result.name=benchmark.getName();
+  result.jobs=jobs;
+  result.resources=resources;
+  unsigned long ops=1;
+  while (true) {
+	unsigned long allocationsBefore=allocations;
+	double start=getSeconds();
+	for (unsigned long i = 0; i < ops; i++)
+	  benchmark.op();
+	double elapsed=getSeconds() - start;
+	if (elapsed >= minSeconds || ops >= (1UL << 30)) {
+	  result.ops=ops;
+	  result.seconds=elapsed;
+	  result.allocations=allocations - allocationsBefore;
+	  return result;
+	}
+	// aim a bit above the minimal time to avoid another round
+	double estimate = elapsed > 0.0 ? ops * minSeconds * 1.2 / elapsed : ops * 2.0;
+	unsigned long next = estimate > ops * 100.0 ? ops * 100 : (unsigned long) estimate;
+	ops = next > ops ? next : ops * 2;
+  }
+}
+
+/**
+ * Jobs with exponential interarrival times and uniform run times between
+ * one minute and ten hours.
+ */
+scheduler::Workload::Ptr createWorkload(const size_t jobs) {
+  util::RNG& rng=util::RNG::instance();
+  scheduler::Workload::Ptr workload(new scheduler::Workload());
+  workload->reserve(jobs);
+  double submitTime=0.0;
+  for (size_t i = 0; i < jobs; i++) {
+	double runTime=60.0 + rng.uniform_deviate() * 35940.0;
+	workload->add(i + 1, submitTime, runTime, runTime * 1.5, 1);
+	submitTime += -30.0 * log(1.0 - rng.uniform_deviate());
+  }
+  return workload;
+}
+
+scheduler::ResourcePool::Ptr createResources(const size_t count) {
+  scheduler::ResourcePool::Ptr resources(new scheduler::ResourcePool());
+  for (unsigned int i = 0; i < count; i++) {
+	std::ostringstream oss;
+	oss << "Resource-" << i;
+	scheduler::PricingPlan::Ptr pricing(new scheduler::LinearPricing(i % 10, 0.1 * (1 + i % 7)));
+	scheduler::SimpleResource::Ptr resource(new scheduler::SimpleResource(i, oss.str(), pricing));
+	resources->add(resource);
+  }
+  return resources;
+}
+
+scheduler::Schedule::Ptr createSchedule(const scheduler::Workload::Ptr& workload,
+	const scheduler::ResourcePool::Ptr& resources) {
+  scheduler::Schedule::Ptr schedule(new scheduler::Schedule(workload, resources));
+  schedule->randomSchedule();
+  schedule->update();
+  return schedule;
+}
+
+/**
+ * A random walk of mutations, at most 64 MB of assignments.
+ */
+std::vector<scheduler::Schedule::Ptr> createMutants(const scheduler::Schedule::Ptr& start,
+	const size_t jobs) {
+  size_t count=(64UL << 20) / (jobs * sizeof(scheduler::Resource::IDType));
+  count = count < 16 ? 16 : (count > 1024 ? 1024 : count);
+  std::vector<scheduler::Schedule::Ptr> mutants;
+  scheduler::Schedule::Ptr current=start;
+  for (size_t i = 0; i < count; i++) {
+	scheduler::Schedule::Ptr mutant(new scheduler::Schedule(*current));
+	mutant->mutate();
+	mutant->update();
+	mutants.push_back(mutant);
+	current=mutant;
+  }
+  return mutants;
+}
+
+/**
+ * Full evaluation of a schedule from its assignment.
+ */
+class UpdateBenchmark : public Benchmark {
+  public:
+	UpdateBenchmark (const scheduler::Schedule::Ptr& schedule) :
+	  Benchmark("schedule-update"), _schedule(schedule),
+	  _assignment(schedule->getAssignment()) {};
+	void op() {
+	  _schedule->setAssignment(_assignment);
+	  _schedule->update();
+	}
+  private:
+	scheduler::Schedule::Ptr _schedule;
+	scheduler::Schedule::AssignmentType _assignment;
+};
+
+/**
+ * One PAES iteration without the archive: copy, mutate and re-evaluate.
+ */
+class MutateBenchmark : public Benchmark {
+  public:
+	MutateBenchmark (const scheduler::Schedule::Ptr& schedule) :
+	  Benchmark("mutate-update"), _schedule(schedule) {};
+	void op() {
+	  scheduler::Schedule::Ptr mutant(new scheduler::Schedule(*_schedule));
+	  mutant->mutate();
+	  mutant->update();
+	}
+  private:
+	scheduler::Schedule::Ptr _schedule;
+};
+
+/**
+ * Archives a random walk of mutants, starting over with an empty
+ * archive after the last one.
+ */
+class ArchiveBenchmark : public Benchmark {
+  public:
+	ArchiveBenchmark (const std::vector<scheduler::Schedule::Ptr>& mutants, const size_t jobs) :
+	  Benchmark("archive-schedule"), _mutants(mutants), _jobs(jobs), _archive(), _next(0) {};
+	void setUp() { _next=0; }
+	void op() {
+	  if (_next == 0)
+		_archive=scheduler::ScheduleArchive::Ptr(new scheduler::ScheduleArchive(config::ARCHIVE_SIZE, _jobs));
+	  _archive->archiveSchedule(_mutants[_next]);
+	  _next = (_next + 1) % _mutants.size();
+	}
+  private:
+	std::vector<scheduler::Schedule::Ptr> _mutants;
+	size_t _jobs;
+	scheduler::ScheduleArchive::Ptr _archive;
+	size_t _next;
+};
+
+class DistanceBenchmark : public Benchmark {
+  public:
+	DistanceBenchmark (const scheduler::ScheduleArchive::Ptr& archive) :
+	  Benchmark("archive-distance"), _archive(archive), _sum(0.0) {};
+	void op() { _sum += _archive->getDistance(); }
+  private:
+	scheduler::ScheduleArchive::Ptr _archive;
+	volatile double _sum;
+};
+
+class LocationsBenchmark : public Benchmark {
+  public:
+	LocationsBenchmark (const scheduler::ScheduleArchive::Ptr& archive) :
+	  Benchmark("archive-locations"), _archive(archive) {};
+	void op() { _archive->updateAllLocations(); }
+  private:
+	scheduler::ScheduleArchive::Ptr _archive;
+};
+
+class ParseBenchmark : public Benchmark {
+  public:
+	ParseBenchmark (const std::string& name, const std::string& filename) :
+	  Benchmark(name), _filename(filename) {};
+	void op() {
+	  scheduler::FileWorkloadFactory factory(_filename);
+	  scheduler::Workload::Ptr workload=factory.parseWorkload();
+	}
+  private:
+	std::string _filename;
+};
+
+void writeTextWorkload(const scheduler::Workload::Ptr& workload, const std::string& filename) {
+  std::ofstream myfile (filename.c_str());
+  if (! myfile.is_open()) {
+	std::cerr << "Unable to open file " << filename << ", aborting" << std::endl;
+	exit(-1);
+  }
+  // two decimals, like the traces the text format comes from
+  myfile.setf(std::ios::fixed);
+  myfile.precision(2);
+  for (scheduler::Workload::IndexType i = 0; i < workload->size(); i++) {
+	myfile << workload->getJobID(i) << "\t" << workload->getSubmitTime(i) << "\t";
+	myfile << workload->getRunTime(i) << "\t" << workload->getWallTime(i) << "\t";
+	myfile << workload->getSize(i) << "\n";
+  }
+}
+
+std::vector<size_t> parseList(const char* list) {
+  std::vector<size_t> retval;
+  std::istringstream iss(list);
+  std::string item;
+  while (getline(iss, item, ',')) {
+	unsigned long value=0;
+	if (sscanf(item.c_str(), "%lu", &value) != 1 || value == 0) {
+	  std::cerr << "Invalid list " << list << " - aborting." << std::endl;
+	  exit(-1);
+	}
+	retval.push_back(value);
+  }
+  return retval;
+}
+
+void printResults(const std::vector<Result>& results, const std::string& format) {
+  std::cout.precision(6);
+  if (format == "json")
+	std::cout << "[" << std::endl;
+  else
+	std::cout << "benchmark\tjobs\tresources\tops\tns/op\tops/s\tallocs/op" << std::endl;
+  for (size_t i = 0; i < results.size(); i++) {
+	const Result& r=results[i];
+	double nsPerOp=r.seconds * 1e9 / r.ops;
+	double opsPerSecond=r.ops / r.seconds;
+	double allocsPerOp=(double) r.allocations / r.ops;
+	if (format == "json") {
+	  std::cout << "  {\"benchmark\": \"" << r.name << "\", \"jobs\": " << r.jobs;
+	  std::cout << ", \"resources\": " << r.resources << ", \"ops\": " << r.ops;
+	  std::cout << ", \"ns_per_op\": " << nsPerOp << ", \"ops_per_s\": " << opsPerSecond;
+	  std::cout << ", \"allocs_per_op\": " << allocsPerOp << "}";
+	  std::cout << (i + 1 < results.size() ? "," : "") << std::endl;
+	} else {
+	  std::cout << r.name << "\t" << r.jobs << "\t" << r.resources << "\t" << r.ops << "\t";
+	  std::cout << nsPerOp << "\t" << opsPerSecond << "\t" << allocsPerOp << std::endl;
+	}
+  }
+  if (format == "json")
+	std::cout << "]" << std::endl;
+}
+
+void printHelp() {
+  std::cout << "PAES benchmark - times the evaluation engine on synthetic workloads" << std::endl;
+  std::cout << "Optional parameters:" << std::endl;
+  std::cout << " -J <LIST>: Comma separated job counts (default 1000,10000,100000,1000000)" << std::endl;
+  std::cout << " -R <LIST>: Comma separated resource counts (default 10,100,1000)" << std::endl;
+  std::cout << " -t <SECONDS>: Minimal time per benchmark (default 0.5)" << std::endl;
+  std::cout << " -b <NAME>: Only run benchmarks whose name contains NAME" << std::endl;
+  std::cout << " -f <tsv|json>: Output format (default tsv)" << std::endl;
+  std::cout << " -d <DIR>: Directory for the temporary workload files (default /tmp)" << std::endl;
+}
+
+int main (int argc, char** argv) {
+  std::vector<size_t> jobCounts=parseList("1000,10000,100000,1000000");
+  std::vector<size_t> resourceCounts=parseList("10,100,1000");
+  double minSeconds=0.5;
+  std::string filter;
+  std::string format("tsv");
+  std::string directory("/tmp");
+  int c;
+
+  opterr = 0;
+  while ((c = getopt (argc, argv, "hJ:R:t:b:f:d:")) != -1)
+	switch (c) {
+	  case 'h':
+		printHelp();
+		exit(0);
+		break;
+	  case 'J':
+		jobCounts=parseList(optarg);
+		break;
+	  case 'R':
+		resourceCounts=parseList(optarg);
+		break;
+	  case 't':
+		if (sscanf(optarg, "%lf", &minSeconds) != 1 || minSeconds <= 0.0) {
+		  std::cerr << "Invalid time " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'b':
+		filter = optarg;
+		break;
+	  case 'f':
+		format = optarg;
+		if (format != "tsv" && format != "json") {
+		  std::cerr << "Unknown output format " << format << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'd':
+		directory = optarg;
+		break;
+	  case '?':
+		if (optopt == 'J' || optopt == 'R' || optopt == 't' || optopt == 'b' || optopt == 'f' || optopt == 'd')
+		  fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+		else if (isprint (optopt))
+		  fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+		else
+		  fprintf (stderr,
+			  "Unknown option character `\\x%x'.\n",
+			  optopt);
+		return 1;
+	  default:
+		abort ();
+	}
+
+  // The engine logs to stdout, keep it for the results.
+  std::ofstream devnull("/dev/null");
+  std::streambuf* stdoutBuffer=std::cout.rdbuf(devnull.rdbuf());
+  std::vector<Result> results;
+  util::RNG::instance().set_seed(1);
+  for (size_t j = 0; j < jobCounts.size(); j++) {
+	size_t jobs=jobCounts[j];
+	std::cerr << "Generating " << jobs << " jobs" << std::endl;
+	scheduler::Workload::Ptr workload=createWorkload(jobs);
+
+	std::vector<Benchmark*> benchmarks;
+	std::ostringstream base;
+	base << directory << "/paes-bench-" << getpid() << "-" << jobs;
+	std::string textFile(base.str() + ".txt");
+	std::string binaryFile(base.str() + ".bin");
+	writeTextWorkload(workload, textFile);
+	scheduler::BinaryWorkloadFile::write(workload, binaryFile);
+	benchmarks.push_back(new ParseBenchmark("parse-text", textFile));
+	benchmarks.push_back(new ParseBenchmark("parse-binary", binaryFile));
+	for (size_t b = 0; b < benchmarks.size(); b++) {
+	  if (benchmarks[b]->getName().find(filter) != std::string::npos) {
+		std::cerr << "Running " << benchmarks[b]->getName() << " on " << jobs << " jobs" << std::endl;
+		results.push_back(measure(*benchmarks[b], jobs, 0, minSeconds));
+	  }
+	  delete benchmarks[b];
+	}
+	unlink(textFile.c_str());
+	unlink(binaryFile.c_str());
+
+	for (size_t r = 0; r < resourceCounts.size(); r++) {
+	  size_t resourceCount=resourceCounts[r];
+	  scheduler::ResourcePool::Ptr resources=createResources(resourceCount);
+	  scheduler::Schedule::Ptr schedule=createSchedule(workload, resources);
+	  std::vector<scheduler::Schedule::Ptr> mutants=createMutants(schedule, jobs);
+	  scheduler::ScheduleArchive::Ptr archive(new scheduler::ScheduleArchive(config::ARCHIVE_SIZE, jobs));
+	  for (size_t i = 0; i < mutants.size(); i++)
+		archive->archiveSchedule(mutants[i]);
+
+	  benchmarks.clear();
+	  benchmarks.push_back(new UpdateBenchmark(createSchedule(workload, resources)));
+	  benchmarks.push_back(new MutateBenchmark(schedule));
+	  benchmarks.push_back(new ArchiveBenchmark(mutants, jobs));
+	  benchmarks.push_back(new DistanceBenchmark(archive));
+	  benchmarks.push_back(new LocationsBenchmark(archive));
+	  for (size_t b = 0; b < benchmarks.size(); b++) {
+		if (benchmarks[b]->getName().find(filter) != std::string::npos) {
+		  std::cerr << "Running " << benchmarks[b]->getName() << " on " << jobs << " jobs, ";
+		  std::cerr << resourceCount << " resources" << std::endl;
+		  results.push_back(measure(*benchmarks[b], jobs, resourceCount, minSeconds));
+		}
+		delete benchmarks[b];
+	  }
+	}
+  }
+  std::cout.rdbuf(stdoutBuffer);
+  printResults(results, format);
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include "binaryworkloadfile.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <stdio.h>
+
+using namespace scheduler;
+
+namespace {
+  const char MAGIC[8] = { 'P', 'A', 'E', 'S', 'W', 'K', 'L', 'D' };
+  const uint32_t VERSION = 1;
+  const uint64_t ALIGNMENT = 64;
+  enum Column { JOB_ID, SUBMIT_TIME, RUN_TIME, WALL_TIME, SIZE, NUM_COLUMNS };
+  const uint64_t COLUMN_WIDTH[NUM_COLUMNS] = {
+	sizeof(scheduler::Job::IDType), sizeof(double), sizeof(double), sizeof(double), sizeof(unsigned int)
+  };
+
+  struct Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t headerSize;
+	uint64_t jobs;
+	uint64_t offsets[NUM_COLUMNS];
+  };
+  typedef char HeaderSizeCheck[(sizeof(Header) == 64) ? 1 : -1];
+  typedef char IDSizeCheck[(sizeof(scheduler::Job::IDType) == 4 && sizeof(unsigned int) == 4) ? 1 : -1];
+
+  uint64_t align(const uint64_t offset) {
+	return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+}
+
+bool BinaryWorkloadFile::isBinaryWorkload(const util::MappedFile& file) {
+  return file.size() >= sizeof(MAGIC) && memcmp(file.begin(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+scheduler::Workload::Ptr BinaryWorkloadFile::load(const util::MappedFile::Ptr& file) {
+  if (file->size() < sizeof(Header) || ! isBinaryWorkload(*file))
+	throw std::runtime_error("Not a binary workload file");
+  const Header* header=reinterpret_cast<const Header*>(file->begin());
+  if (header->version != VERSION || header->headerSize != sizeof(Header))
+	throw std::runtime_error("Unsupported binary workload version or byte order");
+  uint64_t jobs=header->jobs;
+  if (jobs > file->size())
+	throw std::runtime_error("Binary workload file is truncated");
+  for (unsigned int c = 0; c < NUM_COLUMNS; c++) {
+	uint64_t offset=header->offsets[c];
+	if (offset % ALIGNMENT != 0 || offset > file->size() ||
+		jobs * COLUMN_WIDTH[c] > file->size() - offset)
+	  throw std::runtime_error("Binary workload file is truncated or corrupt");
+  }
+  const char* base=file->begin();
+  const scheduler::Job::IDType* jobIDs=
+	reinterpret_cast<const scheduler::Job::IDType*>(base + header->offsets[JOB_ID]);
+  for (uint64_t i = 1; i < jobs; i++) {
+	if (jobIDs[i] <= jobIDs[i-1]) {
+	  std::ostringstream oss;
+	  oss << "Binary workload file: job ids are not increasing at job " << i;
+	  throw std::runtime_error(oss.str());
+	}
+  }
+  scheduler::Workload::Ptr retval(new scheduler::Workload(file, jobs, jobIDs,
+		reinterpret_cast<const double*>(base + header->offsets[SUBMIT_TIME]),
+		reinterpret_cast<const double*>(base + header->offsets[RUN_TIME]),
+		reinterpret_cast<const double*>(base + header->offsets[WALL_TIME]),
+		reinterpret_cast<const unsigned int*>(base + header->offsets[SIZE])));
+  return retval;
+}
+
+void BinaryWorkloadFile::write(const scheduler::Workload::Ptr& workload, const std::string& filename) {
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version=VERSION;
+  header.headerSize=sizeof(Header);
+  header.jobs=workload->size();
+  const char* columns[NUM_COLUMNS] = {
+	reinterpret_cast<const char*>(workload->getJobIDColumn()),
+	reinterpret_cast<const char*>(workload->getSubmitTimeColumn()),
+	reinterpret_cast<const char*>(workload->getRunTimeColumn()),
+	reinterpret_cast<const char*>(workload->getWallTimeColumn()),
+	reinterpret_cast<const char*>(workload->getSizeColumn())
+  };
+  uint64_t offset=align(sizeof(Header));
+  for (unsigned int c = 0; c < NUM_COLUMNS; c++) {
+	header.offsets[c]=offset;
+	offset=align(offset + header.jobs * COLUMN_WIDTH[c]);
+  }
+
+  std::string tmpname(filename + ".tmp");
+  std::ofstream myfile (tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (! myfile.is_open())
+	throw std::runtime_error("Unable to open file " + tmpname);
+  static const char padding[ALIGNMENT] = { 0 };
+  myfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t written=sizeof(header);
+  for (unsigned int c = 0; c < NUM_COLUMNS; c++) {
+	myfile.write(padding, header.offsets[c] - written);
+	myfile.write(columns[c], header.jobs * COLUMN_WIDTH[c]);
+	written=header.offsets[c] + header.jobs * COLUMN_WIDTH[c];
+  }
+  myfile.close();
+  if (! myfile)
+	throw std::runtime_error("Unable to write file " + tmpname);
+  if (rename(tmpname.c_str(), filename.c_str()) != 0)
+	throw std::runtime_error("Unable to rename " + tmpname + " to " + filename);
+}
@@ -0,0 +1,50 @@
+#ifndef PAES_BINARYWORKLOADFILE_HPP
+#define PAES_BINARYWORKLOADFILE_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <mappedfile.hpp>
+#include <stdint.h>
+
+namespace scheduler {
+  /**
+   * Binary columnar workload files. They are mapped into memory and
+   * used as the columns of the workload without any parsing, so all
+   * processes working on the same file share the page cache.
+   *
+   * Layout, all values in host byte order:
+   *   bytes  0- 7  magic "PAESWKLD"
+   *   bytes  8-11  format version (1)
+   *   bytes 12-15  header size (64)
+   *   bytes 16-23  number of jobs
+   *   bytes 24-63  byte offsets of the job id (uint32), submit time,
+   *                run time, wall time (double) and size (uint32)
+   *                columns
+   * Every column starts at a multiple of 64 bytes. The jobs are sorted
+   * by strictly increasing id.
+   */
+  class BinaryWorkloadFile {
+	public:
+	  /**
+	   * Returns true if the file starts with the magic of a binary
+	   * workload file.
+	   */
+	  static bool isBinaryWorkload(const util::MappedFile& file);
+	  /**
+	   * Builds a workload on top of the mapped file. Throws
+	   * std::runtime_error if the file is not a valid binary workload.
+	   */
+	  static scheduler::Workload::Ptr load(const util::MappedFile::Ptr& file);
+	  /**
+	   * Writes the workload. Throws std::runtime_error on failure.
+	   */
+	  static void write(const scheduler::Workload::Ptr& workload, const std::string& filename);
+
+	private:
+	  BinaryWorkloadFile ();
+	  BinaryWorkloadFile (const BinaryWorkloadFile& original);
+	  BinaryWorkloadFile& operator= (const BinaryWorkloadFile& rhs);
+  };
+}
+
+#endif /* PAES_BINARYWORKLOADFILE_HPP */
@@ -0,0 +1,277 @@
+#include "checkpoint.hpp"
+#include <mappedfile.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+
+using namespace scheduler;
+
+namespace {
+  const char MAGIC[8] = { 'P', 'A', 'E', 'S', 'C', 'K', 'P', 'T' };
+  const uint32_t VERSION = 5;
+  typedef char IDSizeCheck[(sizeof(scheduler::Resource::IDType) == 4) ? 1 : -1];
+
+  uint64_t checksum(const char* data, const size_t size) {
+	uint64_t hash=14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++) {
+	  hash ^= (unsigned char) data[i];
+	  hash *= 1099511628211ULL;
+	}
+	return hash;
+  }
+
+  template <typename T>
+  void put(std::string& buffer, const T& value) {
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /**
+   * Reads the values of a checkpoint in order, throws if the data
+   * ends early.
+   */
+  class Reader {
+	public:
+	  Reader (const char* begin, const char* end, const std::string& filename) :
+		_pos(begin), _end(end), _filename(filename) {};
+	  template <typename T>
+	  T get() {
+		T value;
+		read(&value, sizeof(T));
+		return value;
+	  }
+	  void read(void* target, const size_t size) {
+		if ((size_t) (_end - _pos) < size)
+		  throw std::runtime_error("Checkpoint " + _filename + " is truncated");
+		memcpy(target, _pos, size);
+		_pos += size;
+	  }
+	private:
+	  const char* _pos;
+	  const char* _end;
+	  std::string _filename;
+  };
+
+  void putSchedule(std::string& buffer, const scheduler::Schedule::Ptr& schedule) {
+	const Schedule::AssignmentType& assignment=schedule->getAssignment();
+	buffer.append(reinterpret_cast<const char*>(&assignment[0]),
+		assignment.size() * sizeof(scheduler::Resource::IDType));
+	put(buffer, schedule->getTotalQueueTime());
+	put(buffer, schedule->getTotalPrice());
+  }
+
+  /**
+   * Recomputes the schedule and throws if it does not have the stored
+   * queue time and price, i.e. the resources behave differently now.
+   */
+  scheduler::Schedule::Ptr getSchedule(Reader& reader,
+	  const scheduler::Workload::Ptr& workload,
+	  const scheduler::ResourcePool::Ptr& resources,
+	  const std::string& filename) {
+	Schedule::AssignmentType assignment(workload->size());
+	reader.read(&assignment[0], assignment.size() * sizeof(scheduler::Resource::IDType));
+	double queueTime=reader.get<double>();
+	double price=reader.get<double>();
+	scheduler::Schedule::Ptr schedule(new Schedule(workload, resources));
+	schedule->setAssignment(assignment);
+	schedule->update();
+	if (schedule->getTotalQueueTime() != queueTime || schedule->getTotalPrice() != price)
+	  throw std::runtime_error("Checkpoint " + filename +
+		  " was written with different resources or pricing");
+	return schedule;
+  }
+}
+
+Checkpoint::Checkpoint (const scheduler::Workload::Ptr& workload,
+	const scheduler::ResourcePool::Ptr& resources,
+	const config::ExperimentConfig::Ptr& experiment) :
+  _workload(workload),
+  _resources(resources),
+  _experiment(experiment),
+  _loopState(),
+  _seed(0),
+  _current(),
+  _archive(),
+  _grid(),
+  _reportSize(0)
+{
+  memset(&_loopState, 0, sizeof(_loopState));
+  memset(_rngState, 0, sizeof(_rngState));
+}
+
+void Checkpoint::setRNG(const unsigned int seed, const uint64_t* state) {
+  _seed=seed;
+  for (unsigned int i = 0; i < 4; i++)
+	_rngState[i]=state[i];
+}
+
+void Checkpoint::write(const std::string& filename) const {
+  // find the current schedule in the archive
+  uint64_t currentIndex=0;
+  while (currentIndex < _archive.size() && _archive[currentIndex] != _current)
+	currentIndex++;
+
+  std::string buffer;
+  buffer.reserve(128 + (_archive.size() + 1) * _workload->size() * sizeof(scheduler::Resource::IDType));
+  buffer.append(MAGIC, sizeof(MAGIC));
+  put(buffer, VERSION);
+  put(buffer, (uint64_t) _workload->size());
+  put(buffer, (uint64_t) _resources->size());
+  put(buffer, (int32_t) _experiment->getConfigID());
+  put(buffer, (uint64_t) _experiment->getArchiveSize());
+  put(buffer, (uint32_t) _experiment->getLocationBits());
+  std::string description(_resources->str());
+  put(buffer, (uint64_t) description.size());
+  buffer.append(description);
+  put(buffer, (uint32_t) _seed);
+  for (unsigned int i = 0; i < 4; i++)
+	put(buffer, _rngState[i]);
+  put(buffer, (uint64_t) _loopState.iteration);
+  put(buffer, (uint64_t) _loopState.archivedSolutions);
+  put(buffer, (uint64_t) _loopState.lastReportIteration);
+  put(buffer, _loopState.prevDistance);
+  put(buffer, _loopState.lastDistance);
+  put(buffer, (uint64_t) _loopState.lastChangeIteration);
+  put(buffer, (uint8_t) (_loopState.stop ? 1 : 0));
+  put(buffer, (uint64_t) _archive.size());
+  put(buffer, currentIndex);
+  std::map<const Schedule*, uint64_t> indices;
+  for (uint64_t i = 0; i < _archive.size(); i++) {
+	putSchedule(buffer, _archive[i]);
+	indices[_archive[i].get()]=i;
+  }
+  if (currentIndex == _archive.size())
+	putSchedule(buffer, _current);
+  put(buffer, (uint64_t) _grid.size());
+  for (size_t i = 0; i < _grid.size(); i++) {
+	put(buffer, (uint64_t) _grid[i].cell);
+	put(buffer, (uint64_t) _grid[i].members.size());
+	for (size_t j = 0; j < _grid[i].members.size(); j++) {
+	  std::map<const Schedule*, uint64_t>::const_iterator index=indices.find(_grid[i].members[j].get());
+	  if (index == indices.end())
+		throw std::runtime_error("Checkpoint: the grid holds a schedule that is not archived");
+	  put(buffer, (*index).second);
+	}
+  }
+  put(buffer, _reportSize);
+  put(buffer, checksum(buffer.data(), buffer.size()));
+
+  std::string tmpname(filename + ".tmp");
+  int fd=open(tmpname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+	throw std::runtime_error("Unable to open file " + tmpname);
+  const char* data=buffer.data();
+  size_t remaining=buffer.size();
+  while (remaining > 0) {
+	ssize_t written=::write(fd, data, remaining);
+	if (written < 0 && errno == EINTR)
+	  continue;
+	if (written <= 0) {
+	  close(fd);
+	  throw std::runtime_error("Unable to write file " + tmpname);
+	}
+	data += written;
+	remaining -= written;
+  }
+  if (fsync(fd) != 0) {
+	close(fd);
+	throw std::runtime_error("Unable to flush file " + tmpname);
+  }
+  close(fd);
+  if (rename(tmpname.c_str(), filename.c_str()) != 0)
+	throw std::runtime_error("Unable to rename " + tmpname + " to " + filename);
+}
+
+Checkpoint::Ptr Checkpoint::read(const std::string& filename,
+	const scheduler::Workload::Ptr& workload,
+	const scheduler::ResourcePool::Ptr& resources,
+	const config::ExperimentConfig::Ptr& experiment) {
+  util::MappedFile file(filename);
+  if (file.size() < sizeof(MAGIC) + sizeof(uint64_t) ||
+	  memcmp(file.begin(), MAGIC, sizeof(MAGIC)) != 0)
+	throw std::runtime_error(filename + " is not a checkpoint");
+  const char* payloadEnd=file.end() - sizeof(uint64_t);
+  uint64_t storedChecksum;
+  memcpy(&storedChecksum, payloadEnd, sizeof(storedChecksum));
+  if (storedChecksum != checksum(file.begin(), payloadEnd - file.begin()))
+	throw std::runtime_error("Checkpoint " + filename + " is corrupt");
+
+  Reader reader(file.begin() + sizeof(MAGIC), payloadEnd, filename);
+  if (reader.get<uint32_t>() != VERSION)
+	throw std::runtime_error("Unsupported checkpoint version in " + filename);
+  uint64_t jobs=reader.get<uint64_t>();
+  uint64_t resourceCount=reader.get<uint64_t>();
+  if (jobs != workload->size() || resourceCount != resources->size()) {
+	std::ostringstream oss;
+	oss << "Checkpoint " << filename << " was written for " << jobs << " jobs and ";
+	oss << resourceCount << " resources, not " << workload->size() << " jobs and ";
+	oss << resources->size() << " resources";
+	throw std::runtime_error(oss.str());
+  }
+  int32_t configID=reader.get<int32_t>();
+  uint64_t archiveSize=reader.get<uint64_t>();
+  uint32_t locationBits=reader.get<uint32_t>();
+  if (configID != experiment->getConfigID() || archiveSize != experiment->getArchiveSize() ||
+	  locationBits != experiment->getLocationBits()) {
+	std::ostringstream oss;
+	oss << "Checkpoint " << filename << " was written for configuration id " << configID;
+	oss << ", archive size " << archiveSize << " and " << locationBits << " location bits, not ";
+	oss << experiment->getConfigID() << ", " << experiment->getArchiveSize() << " and ";
+	oss << experiment->getLocationBits();
+	throw std::runtime_error(oss.str());
+  }
+  std::string description(reader.get<uint64_t>(), '\0');
+  if (! description.empty())
+	reader.read(&description[0], description.size());
+  if (description != resources->str())
+	throw std::runtime_error("Checkpoint " + filename + " was written for different resources:\n" + description);
+  Checkpoint::Ptr retval(new Checkpoint(workload, resources, experiment));
+  retval->_seed=reader.get<uint32_t>();
+  for (unsigned int i = 0; i < 4; i++)
+	retval->_rngState[i]=reader.get<uint64_t>();
+  retval->_loopState.iteration=reader.get<uint64_t>();
+  retval->_loopState.archivedSolutions=reader.get<uint64_t>();
+  retval->_loopState.lastReportIteration=reader.get<uint64_t>();
+  retval->_loopState.prevDistance=reader.get<double>();
+  retval->_loopState.lastDistance=reader.get<double>();
+  retval->_loopState.lastChangeIteration=reader.get<uint64_t>();
+  retval->_loopState.stop=(reader.get<uint8_t>() != 0);
+  uint64_t schedules=reader.get<uint64_t>();
+  uint64_t currentIndex=reader.get<uint64_t>();
+  if (currentIndex > schedules)
+	throw std::runtime_error("Checkpoint " + filename + " is corrupt");
+  try {
+	for (uint64_t i = 0; i < schedules; i++) {
+	  retval->_archive.push_back(getSchedule(reader, workload, resources, filename));
+	}
+	if (currentIndex < schedules)
+	  retval->_current=retval->_archive[currentIndex];
+	else
+	  retval->_current=getSchedule(reader, workload, resources, filename);
+  } catch (const std::invalid_argument& e) {
+	throw std::runtime_error("Checkpoint " + filename + ": " + e.what());
+  }
+  uint64_t cells=reader.get<uint64_t>();
+  uint64_t members=0;
+  for (uint64_t i = 0; i < cells; i++) {
+	AdaptiveGrid::CellLayout entry;
+	entry.cell=reader.get<uint64_t>();
+	uint64_t count=reader.get<uint64_t>();
+	for (uint64_t j = 0; j < count; j++) {
+	  uint64_t index=reader.get<uint64_t>();
+	  if (index >= schedules)
+		throw std::runtime_error("Checkpoint " + filename + " is corrupt");
+	  entry.members.push_back(retval->_archive[index]);
+	}
+	members += count;
+	retval->_grid.push_back(entry);
+  }
+  if (members != schedules)
+	throw std::runtime_error("Checkpoint " + filename + " is corrupt");
+  retval->_reportSize=reader.get<uint64_t>();
+  return retval;
+}
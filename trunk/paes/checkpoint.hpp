@@ -0,0 +1,127 @@
+#ifndef PAES_CHECKPOINT_HPP
+#define PAES_CHECKPOINT_HPP 1
+
+#include <common.hpp>
+#include <schedule.hpp>
+#include <workload.hpp>
+#include <resourcepool.hpp>
+#include <experimentconfig.hpp>
+#include <adaptivegrid.hpp>
+#include <vector>
+#include <stdint.h>
+
+namespace scheduler {
+  /**
+   * The complete state of an optimizer run: the loop counters and the
+   * termination criterion, the random number generator, the current
+   * schedule, the archived schedules and the length of the runtime
+   * report so far.
+   *
+   * Schedules are stored as their job to resource assignment. The
+   * queue times and prices are recomputed when reading; the queues are
+   * kept sorted by job index, so the recomputed values are the same
+   * bits as the stored schedule had.
+   *
+   * The grid of the archive is stored as it is, cells and members in
+   * the order the grid keeps them, because that order decides which
+   * schedule a full archive replaces. Writing a checkpoint therefore
+   * does not touch the running search, and a resumed run continues
+   * exactly like an uninterrupted one.
+   *
+   * A checkpoint only fits the experiment it was written for. The
+   * configuration id, archive size, grid resolution and the description
+   * of the resources are stored and compared on reading, and so are the
+   * queue time and price of every stored schedule, which catches any
+   * other change of the resources or their pricing.
+   *
+   * Binary layout, all values in host byte order:
+   *   magic "PAESCKPT", uint32 version (5), uint64 number of jobs and
+   *   resources, int32 configuration id, uint64 archive size, uint32
+   *   location bits, uint64 length and text of the resource pool
+   *   description, uint32 seed, 4 x uint64 generator state, uint64
+   *   iteration, archived solutions and last report iteration, double
+   *   previous and last distance, uint64 iteration of the last change
+   *   of the distance, uint8 stop flag,
+   *   uint64 archive size and index of the current schedule in the
+   *   archive (archive size if it is not archived), the assignments
+   *   (uint32 per job) of the archive and of the current schedule if
+   *   it is not archived, each followed by the queue time and price of
+   *   the schedule as doubles, uint64 number of grid cells, per cell
+   *   uint64 cell, number of members and their archive indices, uint64
+   *   size of the runtime report and finally an FNV-1a checksum of
+   *   everything before.
+   */
+  class Checkpoint {
+	public:
+	  typedef std::tr1::shared_ptr<Checkpoint> Ptr;
+	  /**
+	   * The counters of the optimizer main loop.
+	   */
+	  struct LoopState {
+		unsigned long iteration;
+		unsigned long archivedSolutions;
+		unsigned long lastReportIteration;
+		double prevDistance;
+		double lastDistance;
+		unsigned long lastChangeIteration;
+		bool stop;
+	  };
+	  Checkpoint (const scheduler::Workload::Ptr& workload,
+		  const scheduler::ResourcePool::Ptr& resources,
+		  const config::ExperimentConfig::Ptr& experiment);
+	  virtual ~Checkpoint() {};
+	  /**
+	   * Writes the checkpoint to a temporary file, flushes it to disk
+	   * and renames it, so the file is either the old or the new
+	   * checkpoint. Throws std::runtime_error on failure.
+	   */
+	  void write(const std::string& filename) const;
+	  /**
+	   * Reads a checkpoint of a run on the given workload, resources and
+	   * experiment. Throws std::runtime_error if the file is truncated,
+	   * corrupt or belongs to a different workload or experiment.
+	   */
+	  static Ptr read(const std::string& filename,
+		  const scheduler::Workload::Ptr& workload,
+		  const scheduler::ResourcePool::Ptr& resources,
+		  const config::ExperimentConfig::Ptr& experiment);
+	  const LoopState& getLoopState() const { return _loopState; };
+	  void setLoopState(const LoopState& loopState) { _loopState=loopState; };
+	  unsigned int getSeed() const { return _seed; };
+	  const uint64_t* getRNGState() const { return _rngState; };
+	  void setRNG(const unsigned int seed, const uint64_t* state);
+	  /**
+	   * The current schedule may be one of the archived schedules.
+	   */
+	  const scheduler::Schedule::Ptr& getCurrent() const { return _current; };
+	  void setCurrent(const scheduler::Schedule::Ptr& current) { _current=current; };
+	  const std::vector<scheduler::Schedule::Ptr>& getArchive() const { return _archive; };
+	  void setArchive(const std::vector<scheduler::Schedule::Ptr>& archive) { _archive=archive; };
+	  /**
+	   * The grid of the archive, its members must be archived schedules.
+	   */
+	  const scheduler::AdaptiveGrid::LayoutType& getGrid() const { return _grid; };
+	  void setGrid(const scheduler::AdaptiveGrid::LayoutType& grid) { _grid=grid; };
+	  /**
+	   * The size of the runtime report in bytes.
+	   */
+	  uint64_t getReportSize() const { return _reportSize; };
+	  void setReportSize(const uint64_t size) { _reportSize=size; };
+
+	private:
+	  Checkpoint (const Checkpoint& original);
+	  Checkpoint& operator= (const Checkpoint& rhs);
+	  scheduler::Workload::Ptr _workload;
+	  scheduler::ResourcePool::Ptr _resources;
+	  config::ExperimentConfig::Ptr _experiment;
+	  LoopState _loopState;
+	  unsigned int _seed;
+	  uint64_t _rngState[4];
+	  scheduler::Schedule::Ptr _current;
+	  std::vector<scheduler::Schedule::Ptr> _archive;
+	  scheduler::AdaptiveGrid::LayoutType _grid;
+	  uint64_t _reportSize;
+  };
+}
+
+#endif /* PAES_CHECKPOINT_HPP */
@@ -0,0 +1,24 @@
+#ifndef PAES_CLOCK_HPP
+#define PAES_CLOCK_HPP 1
+
+#include <sys/time.h>  /* gettimeofday and friends.						 */
+#include <time.h>
+
+namespace util {
+  inline long getCurrentMilliseconds() {
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (((long)tv.tv_sec * 1000) + (tv.tv_usec / 1000));
+  }
+
+  /**
+   * CPU time consumed by the calling thread, in seconds.
+   */
+  inline double getThreadCPUSeconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+  }
+}
+
+#endif /* PAES_CLOCK_HPP */
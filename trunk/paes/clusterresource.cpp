@@ -0,0 +1,343 @@
+#include "clusterresource.hpp"
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <math.h>
+#include <limits.h>
+#include <pthread.h>
+
+using namespace scheduler;
+
+namespace {
+  /**
+   * A running job. In the completion heap, the entry with the earliest
+   * finish time is on top.
+   */
+  struct Running {
+	double finish;
+	double estimatedEnd;
+	unsigned int nodes;
+	unsigned int position;
+	bool operator< (const Running& rhs) const {
+	  return finish > rhs.finish || (finish == rhs.finish && position > rhs.position);
+	}
+  };
+
+  /**
+   * An entry of the availability profile: the nodes come back at the
+   * estimated end at the latest.
+   */
+  struct Reserved {
+	double estimatedEnd;
+	unsigned int nodes;
+	unsigned int position;
+	bool operator< (const Reserved& rhs) const {
+	  return estimatedEnd < rhs.estimatedEnd ||
+		(estimatedEnd == rhs.estimatedEnd && position < rhs.position);
+	}
+  };
+
+  struct Scratch {
+	std::vector<Running> completions;
+	std::vector<Reserved> profile;
+	std::vector<unsigned int> waitingNodes;
+	std::vector<double> waitingEstimates;
+  };
+
+  pthread_key_t scratchKey;
+  pthread_once_t scratchOnce=PTHREAD_ONCE_INIT;
+
+  void deleteScratch(void* scratch) {
+	delete static_cast<Scratch*>(scratch);
+  }
+
+  void createScratchKey() {
+	pthread_key_create(&scratchKey, deleteScratch);
+  }
+
+  Scratch& getScratch() {
+	pthread_once(&scratchOnce, createScratchKey);
+	Scratch* scratch=static_cast<Scratch*>(pthread_getspecific(scratchKey));
+	if (scratch == NULL) {
+	  scratch=new Scratch();
+	  pthread_setspecific(scratchKey, scratch);
+	}
+	return *scratch;
+  }
+
+  /**
+   * The waiting jobs, a segment tree over the queue positions. Every
+   * subtree keeps the smallest node count and wall time estimate of its
+   * waiting jobs, positions that are not waiting hold NONE and HUGE_VAL.
+   * A backfill search only descends into subtrees that can hold a
+   * fitting job, so a pass does not walk the whole queue.
+   */
+  class WaitingJobs {
+	public:
+	  static const unsigned int NONE = UINT_MAX;
+	  WaitingJobs (std::vector<unsigned int>& nodes, std::vector<double>& estimates,
+		  const size_t size) :
+		_nodes(nodes), _estimates(estimates), _leaves(1) {
+		while (_leaves < size)
+		  _leaves *= 2;
+		_nodes.assign(2 * _leaves, NONE);
+		_estimates.assign(2 * _leaves, HUGE_VAL);
+	  };
+	  void insert(const size_t position, const unsigned int nodes, const double estimate) {
+		set(position, nodes, estimate);
+	  };
+	  void remove(const size_t position) { set(position, NONE, HUGE_VAL); };
+	  bool isEmpty() const { return _nodes[1] == NONE; };
+	  /**
+	   * The first waiting position, the queue must not be empty.
+	   */
+	  size_t getFirst() const {
+		size_t i=1;
+		while (i < _leaves)
+		  i = (_nodes[2 * i] != NONE) ? 2 * i : 2 * i + 1;
+		return i - _leaves;
+	  };
+	  /**
+	   * The first waiting position from the given one on that fits into
+	   * the free nodes and either ends by the reservation or fits into
+	   * the extra nodes. Returns NONE if there is none.
+	   */
+	  size_t findBackfill(const size_t from, const unsigned int free,
+		  const unsigned int extra, const double now, const double reservation) const {
+		return find(1, 0, _leaves, from, free, std::min(free, extra), now, reservation);
+	  };
+
+	private:
+	  void set(size_t position, const unsigned int nodes, const double estimate) {
+		size_t i=position + _leaves;
+		_nodes[i]=nodes;
+		_estimates[i]=estimate;
+		for (i /= 2; i > 0; i /= 2) {
+		  _nodes[i]=std::min(_nodes[2 * i], _nodes[2 * i + 1]);
+		  _estimates[i]=std::min(_estimates[2 * i], _estimates[2 * i + 1]);
+		}
+	  };
+	  size_t find(const size_t i, const size_t begin, const size_t end,
+		  const size_t from, const unsigned int free, const unsigned int extra,
+		  const double now, const double reservation) const {
+		// now + estimate grows with the estimate, so the smallest
+		// estimate of a subtree ends first
+		if (end <= from || _nodes[i] > free ||
+			(_nodes[i] > extra && now + _estimates[i] > reservation))
+		  return NONE;
+		if (i >= _leaves)
+		  return begin;
+		size_t middle=(begin + end) / 2;
+		size_t found=find(2 * i, begin, middle, from, free, extra, now, reservation);
+		if (found == NONE)
+		  found=find(2 * i + 1, middle, end, from, free, extra, now, reservation);
+		return found;
+	  };
+	  std::vector<unsigned int>& _nodes;
+	  std::vector<double>& _estimates;
+	  size_t _leaves;
+  };
+  const unsigned int WaitingJobs::NONE;
+
+  /**
+   * The simulation state of one reSchedule() call.
+   */
+  class Simulation {
+	public:
+	  Simulation (const scheduler::Workload& jobs, scheduler::JobQueue& queue,
+		  Scratch& scratch, const unsigned int nodes) :
+		_jobs(jobs), _queue(queue), _queuedJobs(queue.getJobs()),
+		_completions(scratch.completions), _profile(scratch.profile),
+		_waiting(scratch.waitingNodes, scratch.waitingEstimates, queue.getJobs().size()),
+		_free(nodes) {
+		_completions.clear();
+		_profile.clear();
+	  };
+	  void start(const unsigned int position, const unsigned int nodes, const double now) {
+		Workload::IndexType job=_queuedJobs[position];
+		double runtime=_jobs.getRunTime(job);
+		double estimate=std::max(_jobs.getWallTime(job), runtime);
+		_queue.setTimes(position, now, now - _jobs.getSubmitTime(job), now + runtime);
+		Running running={ now + runtime, now + estimate, nodes, position };
+		_completions.push_back(running);
+		std::push_heap(_completions.begin(), _completions.end());
+		Reserved reserved={ now + estimate, nodes, position };
+		_profile.insert(std::upper_bound(_profile.begin(), _profile.end(), reserved), reserved);
+		_waiting.remove(position);
+		_free -= nodes;
+	  };
+	  /**
+	   * Frees the nodes of all jobs finished by now, returns false if
+	   * there were none.
+	   */
+	  bool complete(const double now) {
+		bool completed=false;
+		while (! _completions.empty() && _completions.front().finish <= now) {
+		  const Running& done=_completions.front();
+		  Reserved key={ done.estimatedEnd, done.nodes, done.position };
+		  _profile.erase(std::lower_bound(_profile.begin(), _profile.end(), key));
+		  _free += done.nodes;
+		  std::pop_heap(_completions.begin(), _completions.end());
+		  _completions.pop_back();
+		  completed=true;
+		}
+		return completed;
+	  };
+	  double getNextCompletion() const { return _completions.front().finish; };
+	  bool isRunning() const { return ! _completions.empty(); };
+	  unsigned int getFree() const { return _free; };
+	  /**
+	   * The time the first waiting job can start at the latest, and the
+	   * nodes that are free at that time beyond the ones it needs.
+	   */
+	  std::pair<double, unsigned int> getReservation(const unsigned int needed, const double now) const {
+		unsigned int available=_free;
+		double time=now;
+		std::vector<Reserved>::const_iterator it;
+		for(  it = _profile.begin(); it != _profile.end() && available < needed; it++) {
+		  available += (*it).nodes;
+		  time=(*it).estimatedEnd;
+		}
+		return std::make_pair(time, available > needed ? available - needed : 0);
+	  };
+	  WaitingJobs& getWaiting() { return _waiting; };
+
+	private:
+	  const scheduler::Workload& _jobs;
+	  scheduler::JobQueue& _queue;
+	  const JobQueue::JobListType& _queuedJobs;
+	  std::vector<Running>& _completions;
+	  std::vector<Reserved>& _profile;
+	  WaitingJobs _waiting;
+	  unsigned int _free;
+  };
+}
+
+ClusterResource::ClusterResource (IDType resourceID, const std::string& resourceName,
+	const unsigned int nodes, scheduler::PricingPlan::Ptr pricingPlan) :
+  Resource (resourceID, resourceName, pricingPlan),
+  _nodes(nodes)
+{
+  if (nodes == 0)
+	throw std::invalid_argument("Cluster " + resourceName + " has no nodes");
+}
+
+const std::string ClusterResource::str() {
+  std::ostringstream oss;
+  oss << "# Cluster resource " << getResourceName() << "(id: " << getResourceID() << "), ";
+  oss << _nodes << " nodes, " << _pricingPlan->str();
+  return oss.str();
+}
+
+unsigned int ClusterResource::getNodes(const scheduler::Workload& jobs,
+	const scheduler::Workload::IndexType& jobIndex) const {
+  unsigned int size=jobs.getSize(jobIndex);
+  if (size == 0)
+	return 1;
+  return size < _nodes ? size : _nodes;
+}
+
+void ClusterResource::reSchedule(const scheduler::Workload::Ptr& workload,
+	scheduler::JobQueue& queue) const {
+  const scheduler::Workload& jobs=*workload;
+  const JobQueue::JobListType& queuedJobs=queue.getJobs();
+  Simulation simulation(jobs, queue, getScratch(), _nodes);
+  WaitingJobs& waiting=simulation.getWaiting();
+  size_t scanned=0; // positions the last backfill pass checked
+  unsigned int arrived=0;
+  double now=0.0;
+  while (arrived < queuedJobs.size() || ! waiting.isEmpty()) {
+	// advance to the next arrival or completion
+	double next=HUGE_VAL;
+	if (arrived < queuedJobs.size())
+	  next=jobs.getSubmitTime(queuedJobs[arrived]);
+	if (simulation.isRunning() && simulation.getNextCompletion() < next)
+	  next=simulation.getNextCompletion();
+	if (next > now)
+	  now=next;
+	bool changed=simulation.complete(now);
+	while (arrived < queuedJobs.size() && jobs.getSubmitTime(queuedJobs[arrived]) <= now) {
+	  Workload::IndexType job=queuedJobs[arrived];
+	  waiting.insert(arrived++, getNodes(jobs, job),
+		  std::max(jobs.getWallTime(job), jobs.getRunTime(job)));
+	}
+
+	// FCFS: start the first jobs while they fit
+	size_t head=0;
+	while (! waiting.isEmpty()) {
+	  head=waiting.getFirst();
+	  unsigned int nodes=getNodes(jobs, queuedJobs[head]);
+	  if (nodes > simulation.getFree())
+		break;
+	  simulation.start(head, nodes, now);
+	  changed=true;
+	}
+	if (waiting.isEmpty() || simulation.getFree() == 0)
+	  continue;
+
+	// EASY: backfill later jobs that do not delay the first one, in
+	// job id order. A job that does not fit keeps not fitting during
+	// the pass, as the free and extra nodes only decrease. Unless jobs
+	// completed or the first job changed, the jobs checked by the last
+	// pass still do not fit: the free nodes and the reservation are the
+	// same and the time has only moved on. Only the new arrivals need
+	// to be checked then.
+	std::pair<double, unsigned int> reservation=simulation.getReservation(
+		getNodes(jobs, queuedJobs[head]), now);
+	unsigned int extra=reservation.second;
+	size_t from=(changed || scanned <= head) ? head + 1 : scanned;
+	while (simulation.getFree() > 0) {
+	  size_t position=waiting.findBackfill(from, simulation.getFree(), extra,
+		  now, reservation.first);
+	  if (position == WaitingJobs::NONE)
+		break;
+	  Workload::IndexType job=queuedJobs[position];
+	  unsigned int nodes=getNodes(jobs, job);
+	  double estimate=std::max(jobs.getWallTime(job), jobs.getRunTime(job));
+	  if (now + estimate > reservation.first)
+		extra -= nodes;
+	  simulation.start(position, nodes, now);
+	  from=position + 1;
+	}
+	scanned=arrived;
+  }
+  queue.setEvaluated();
+}
+
+bool ClusterResource::sanityCheck(const scheduler::Workload::Ptr& workload,
+	scheduler::JobQueue& queue) const {
+  bool success=true;
+  const JobQueue::JobListType& queuedJobs=queue.getJobs();
+  AllocationListType allocations=getAllocations(workload, queue);
+  // node usage over time: +nodes at start, -nodes at finish
+  std::vector<std::pair<double, int> > events;
+  for (size_t i=0; i < allocations.size(); i++) {
+	scheduler::Allocation::Ptr current=allocations[i];
+	if (current->getStartTime() < workload->getSubmitTime(queuedJobs[i])) {
+	  std::cout << "Start time before submit time!" << std::endl;
+	  std::cout << "Job: " << current->str() << std::endl;
+	  success=false;
+	}
+	int nodes=getNodes(*workload, queuedJobs[i]);
+	events.push_back(std::make_pair(current->getStartTime(), nodes));
+	events.push_back(std::make_pair(current->getFinishTime(), -nodes));
+  }
+  // at equal times, finishing jobs free their nodes first
+  std::sort(events.begin(), events.end());
+  int used=0;
+  for (size_t i=0; i < events.size(); i++) {
+	used += events[i].second;
+	if (used > (int) _nodes) {
+	  std::cout << "More than " << _nodes << " nodes in use at " << events[i].first << "!" << std::endl;
+	  success=false;
+	  break;
+	}
+  }
+  if (success)
+	std::cout << "Cluster Resource "<< getResourceName() <<": Sanity check successful." << std::endl;
+  else
+	std::cout << "Cluster Resource "<< getResourceName() << ": Sanity FAIL" << std::endl;
+  return success;
+}
@@ -0,0 +1,53 @@
+#ifndef PAES_CLUSTERRESOURCE_HPP
+#define PAES_CLUSTERRESOURCE_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <resource.hpp>
+#include <jobqueue.hpp>
+
+namespace scheduler {
+  /**
+   * A parallel cluster of identical nodes. Each job occupies getSize()
+   * nodes for its runtime; jobs wider than the cluster get all nodes.
+   * Jobs are started in job id order, and EASY backfilling starts later
+   * jobs early if they do not delay the reservation of the first
+   * waiting job. Reservations use the wall time estimate, or the
+   * runtime if the estimate is missing or too small.
+   *
+   * reSchedule() simulates the queue event by event. Completions come
+   * from a heap ordered by finish time. The availability profile is the
+   * list of running jobs ordered by estimated end; it gives the
+   * reservation time of the first waiting job. Both hold at most one
+   * entry per node. The waiting jobs are a segment tree over the queue
+   * positions that keeps the smallest node count and estimate of every
+   * subtree; the first waiting job and each backfilled job are found by
+   * descending it instead of scanning the queue. Scratch buffers are
+   * kept per thread, so no memory is allocated once they have grown.
+   */
+  class ClusterResource : public scheduler::Resource {
+	public:
+	  typedef std::tr1::shared_ptr<ClusterResource> Ptr;
+	  ClusterResource (IDType resourceID, const std::string& resourceName,
+		  const unsigned int nodes, scheduler::PricingPlan::Ptr pricingPlan);
+	  virtual ~ClusterResource() {};
+
+	  const std::string str();
+	  unsigned int getNodes() const { return _nodes; };
+	  void reSchedule(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const;
+	  bool sanityCheck(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const;
+
+	protected:
+	  unsigned int getNodes(const scheduler::Workload& jobs,
+		  const scheduler::Workload::IndexType& jobIndex) const;
+
+	private:
+	  ClusterResource (const ClusterResource& original);
+	  ClusterResource& operator= (const ClusterResource& rhs);
+	  unsigned int _nodes;
+  };
+}
+
+#endif /* PAES_CLUSTERRESOURCE_HPP */
@@ -4,23 +4,14 @@
 #include <linearpricing.hpp>
 #include <simpleresource.hpp>
 
-const std::string config::getConfigString() {
-  std::ostringstream oss;
-  oss << "Configuration id: " << config::CONFIG_NAME;
-  oss << ", Location size: " << config::LOCATION_DIMENSION_SIZE;
-  oss << ", Archive size: " << config::ARCHIVE_SIZE;
-  oss << ", Max iterations: " << config::MAX_ITERATION;
-  return oss.str();
-}
-  
-scheduler::ResourcePool::Ptr config::createResourcePool() {
-  if (CONFIG_NAME == config::THREE_SIMPLE_RESOURCES)
+scheduler::ResourcePool::Ptr config::createResourcePool(const int configID) {
+  if (configID == config::THREE_SIMPLE_RESOURCES)
 	  return create3SimpleResources();
-  else if(CONFIG_NAME == config::ADAPTABLE_SIMPLE_RESSOURCES)
+  else if(configID == config::ADAPTABLE_SIMPLE_RESSOURCES)
     return createAdaptableSimpleResources();
   else {
 	std::ostringstream oss;
-	oss << "Config id " << CONFIG_NAME << ": no such configuration available.";
+	oss << "Config id " << configID << ": no such configuration available.";
 	throw std::runtime_error(oss.str());
   }
 }
@@ -19,6 +19,10 @@ namespace config {
   const static unsigned int NUM_LOCATION_BITS=2*LOCATION_DIMENSION_SIZE;
   const static size_t ARCHIVE_SIZE=1000;
   const static unsigned int MAX_ITERATION=10000000;
+  // Island model: iterations between two migrations, and the maximal
+  // number of schedules an island sends per migration.
+  const static unsigned int MIGRATION_INTERVAL=10000;
+  const static size_t MIGRATION_SIZE=10;
 
   // Sets the number, timePrices and basePrices for the adabtable resources
   const static unsigned int LOOP_COUNT = 10;
@@ -30,10 +34,10 @@ namespace config {
   };
   // end adaptable resources
 
-  // Returns a string describing the current configuration as set above.
-  const std::string getConfigString();
-  // Builds a configuration
-  scheduler::ResourcePool::Ptr createResourcePool();
+  // Builds the resource set with the given id, by default the one
+  // set above. The other compile-time values are the defaults of
+  // ExperimentConfig.
+  scheduler::ResourcePool::Ptr createResourcePool(const int configID = CONFIG_NAME);
   // private factory methods.
   scheduler::ResourcePool::Ptr create3SimpleResources();
   scheduler::ResourcePool::Ptr createAdaptableSimpleResources();
@@ -0,0 +1,35 @@
+#include "conservativeresource.hpp"
+#include <sstream>
+#include <algorithm>
+
+using namespace scheduler;
+
+const std::string ConservativeResource::str() {
+  std::ostringstream oss;
+  oss << "# Conservative backfilling cluster " << getResourceName() << "(id: " << getResourceID() << "), ";
+  oss << getNodes() << " nodes, " << _pricingPlan->str();
+  return oss.str();
+}
+
+void ConservativeResource::reSchedule(const scheduler::Workload::Ptr& workload,
+	scheduler::JobQueue& queue) const {
+  const scheduler::Workload& jobs=*workload;
+  const JobQueue::JobListType& queuedJobs=queue.getJobs();
+  ReservationCalendar& calendar=queue.getCalendar();
+  size_t first=queue.getFirstChanged();
+  if (! calendar.isActive()) {
+	calendar.reset(queuedJobs.size());
+	first=0;
+  }
+  calendar.releaseFrom(first);
+  for (size_t i=first; i < queuedJobs.size(); i++) {
+	Workload::IndexType job=queuedJobs[i];
+	unsigned int nodes=getNodes(jobs, job);
+	double runtime=jobs.getRunTime(job);
+	double estimate=std::max(jobs.getWallTime(job), runtime);
+	double start=calendar.findEarliest(jobs.getSubmitTime(job), estimate, nodes, getNodes());
+	calendar.reserve(i, start, start + estimate, nodes);
+	queue.setTimes(i, start, start - jobs.getSubmitTime(job), start + runtime);
+  }
+  queue.setEvaluated();
+}
@@ -0,0 +1,41 @@
+#ifndef PAES_CONSERVATIVERESOURCE_HPP
+#define PAES_CONSERVATIVERESOURCE_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <clusterresource.hpp>
+#include <jobqueue.hpp>
+
+namespace scheduler {
+  /**
+   * A cluster with conservative backfilling: in job id order, every job
+   * gets a reservation at the earliest time it fits in without moving
+   * the reservations of the jobs before it. Later jobs may start first
+   * if they fit into a gap. Reservations last for the wall time
+   * estimate, or the runtime if the estimate is missing or too small,
+   * and are not moved forward when a job finishes early.
+   *
+   * The reservations are kept in the ReservationCalendar of the queue.
+   * A job's reservation depends only on the jobs before it, so when a
+   * mutation moves a job, the reservations before its position are kept
+   * and only the ones from there on are made again.
+   */
+  class ConservativeResource : public scheduler::ClusterResource {
+	public:
+	  typedef std::tr1::shared_ptr<ConservativeResource> Ptr;
+	  ConservativeResource (IDType resourceID, const std::string& resourceName,
+		  const unsigned int nodes, scheduler::PricingPlan::Ptr pricingPlan) :
+		ClusterResource(resourceID, resourceName, nodes, pricingPlan) {};
+	  virtual ~ConservativeResource() {};
+
+	  const std::string str();
+	  void reSchedule(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const;
+
+	private:
+	  ConservativeResource (const ConservativeResource& original);
+	  ConservativeResource& operator= (const ConservativeResource& rhs);
+  };
+}
+
+#endif /* PAES_CONSERVATIVERESOURCE_HPP */
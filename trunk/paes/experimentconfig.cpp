@@ -0,0 +1,105 @@
+#include "experimentconfig.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <linearpricing.hpp>
+#include <simpleresource.hpp>
+#include <clusterresource.hpp>
+#include <conservativeresource.hpp>
+
+using namespace config;
+
+ExperimentConfig::ExperimentConfig () :
+  _filename(),
+  _configID(config::CONFIG_NAME),
+  _archiveSize(config::ARCHIVE_SIZE),
+  _locationBits(config::LOCATION_DIMENSION_SIZE),
+  _maxIterations(config::MAX_ITERATION),
+  _resources()
+{ }
+
+ExperimentConfig::Ptr ExperimentConfig::load(const std::string& filename) {
+  std::ifstream myfile (filename.c_str());
+  if (! myfile.is_open())
+	throw std::runtime_error("Unable to open file " + filename);
+  ExperimentConfig::Ptr retval(new ExperimentConfig());
+  retval->_filename=filename;
+  std::string line;
+  unsigned long lineNumber=0;
+  while (getline(myfile, line)) {
+	lineNumber++;
+	std::string::size_type comment=line.find('#');
+	if (comment != std::string::npos)
+	  line.erase(comment);
+	std::istringstream iss(line);
+	std::string key;
+	if (! (iss >> key))
+	  continue;
+	bool valid=false;
+	if (key == "config-id") {
+	  valid = (iss >> retval->_configID);
+	} else if (key == "archive-size") {
+	  valid = (iss >> retval->_archiveSize) && retval->_archiveSize > 0;
+	} else if (key == "location-bits") {
+	  valid = (iss >> retval->_locationBits) &&
+		retval->_locationBits > 0 && retval->_locationBits <= 32;
+	} else if (key == "max-iterations") {
+	  valid = (iss >> retval->_maxIterations) && retval->_maxIterations > 0;
+	} else if (key == "resource") {
+	  std::string pricing;
+	  ResourceDefinition resource;
+	  resource.nodes=0;
+	  resource.weight=1.0;
+	  valid = (iss >> resource.type >> resource.name) &&
+		(resource.type == "simple" ||
+		 ((resource.type == "cluster" || resource.type == "conservative") &&
+		  (iss >> resource.nodes) && resource.nodes > 0)) &&
+		(iss >> pricing >> resource.basePrice >> resource.timePrice) && pricing == "linear" &&
+		resource.basePrice >= 0 && resource.timePrice >= 0;
+	  std::string option;
+	  if (valid && (iss >> option))
+		valid = option == "weight" && (iss >> resource.weight) && resource.weight > 0;
+	  if (valid)
+		retval->_resources.push_back(resource);
+	}
+	std::string rest;
+	if (! valid || (iss >> rest)) {
+	  std::ostringstream oss;
+	  oss << filename << ":" << lineNumber << ": invalid setting \"" << line << "\"";
+	  throw std::runtime_error(oss.str());
+	}
+  }
+  return retval;
+}
+
+scheduler::ResourcePool::Ptr ExperimentConfig::createResourcePool() const {
+  if (_resources.empty())
+	return config::createResourcePool(_configID);
+  scheduler::ResourcePool::Ptr resources(new scheduler::ResourcePool());
+  for(unsigned int i=0; i<_resources.size(); i++) {
+	scheduler::PricingPlan::Ptr pricing(new scheduler::LinearPricing(
+		  _resources[i].basePrice, _resources[i].timePrice));
+	scheduler::Resource::Ptr resource;
+	if (_resources[i].type == "conservative")
+	  resource=scheduler::Resource::Ptr(new scheduler::ConservativeResource(i, _resources[i].name,
+			_resources[i].nodes, pricing));
+	else if (_resources[i].type == "cluster")
+	  resource=scheduler::Resource::Ptr(new scheduler::ClusterResource(i, _resources[i].name,
+			_resources[i].nodes, pricing));
+	else
+	  resource=scheduler::Resource::Ptr(new scheduler::SimpleResource(i, _resources[i].name, pricing));
+	resources->add(resource, _resources[i].weight);
+  }
+  return resources;
+}
+
+const std::string ExperimentConfig::str() const {
+  std::ostringstream oss;
+  oss << "Configuration id: " << _configID;
+  oss << ", Location size: " << _locationBits;
+  oss << ", Archive size: " << _archiveSize;
+  oss << ", Max iterations: " << _maxIterations;
+  if (! _filename.empty())
+	oss << ", Definition file: " << _filename;
+  return oss.str();
+}
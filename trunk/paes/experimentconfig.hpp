@@ -0,0 +1,73 @@
+#ifndef PAES_EXPERIMENTCONFIG_HPP
+#define PAES_EXPERIMENTCONFIG_HPP 1
+
+#include <common.hpp>
+#include <config.hpp>
+#include <resourcepool.hpp>
+#include <vector>
+
+namespace config {
+  /**
+   * The settings of one experiment. Without a definition file, the
+   * compile-time configuration of config.hpp is used. A definition
+   * file has one setting per line, '#' starts a comment:
+   *
+   *   config-id <INT>          id of a built-in resource set, also
+   *                            reported in the result headers
+   *   archive-size <UINT>      maximal number of archived schedules
+   *   location-bits <1..32>    grid resolution per objective
+   *   max-iterations <UINT>    default for -n
+   *   resource simple <NAME> linear <BASE PRICE> <TIME PRICE>
+   *                            a resource with a linear pricing plan.
+   *                            If any resource is given, the built-in
+   *                            set is not used. Resource ids are
+   *                            assigned in the order of the lines.
+   *                            Any resource line may end with
+   *                            "weight <W>", the resource's share of
+   *                            random assignments and mutations
+   *                            (default 1).
+   *   resource cluster <NAME> <NODES> linear <BASE PRICE> <TIME PRICE>
+   *                            a parallel cluster with EASY
+   *                            backfilling, see ClusterResource
+   *   resource conservative <NAME> <NODES> linear <BASE PRICE> <TIME PRICE>
+   *                            a parallel cluster with conservative
+   *                            backfilling, see ConservativeResource
+   */
+  class ExperimentConfig {
+	public:
+	  typedef std::tr1::shared_ptr<ExperimentConfig> Ptr;
+	  ExperimentConfig ();
+	  virtual ~ExperimentConfig() {};
+	  /**
+	   * Reads a definition file. Throws std::runtime_error with the
+	   * line number if it is malformed.
+	   */
+	  static Ptr load(const std::string& filename);
+	  int getConfigID() const { return _configID; };
+	  size_t getArchiveSize() const { return _archiveSize; };
+	  unsigned int getLocationBits() const { return _locationBits; };
+	  unsigned int getMaxIterations() const { return _maxIterations; };
+	  scheduler::ResourcePool::Ptr createResourcePool() const;
+	  const std::string str() const;
+
+	private:
+	  struct ResourceDefinition {
+		std::string type;
+		std::string name;
+		unsigned int nodes; // 0 for a simple resource
+		double basePrice;
+		double timePrice;
+		double weight;
+	  };
+	  ExperimentConfig (const ExperimentConfig& original);
+	  ExperimentConfig& operator= (const ExperimentConfig& rhs);
+	  std::string _filename;
+	  int _configID;
+	  size_t _archiveSize;
+	  unsigned int _locationBits;
+	  unsigned int _maxIterations;
+	  std::vector<ResourceDefinition> _resources;
+  };
+}
+
+#endif /* PAES_EXPERIMENTCONFIG_HPP */
@@ -0,0 +1,124 @@
+#include "fcfsscan.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FCFS_AVX2 1
+#endif
+
+using namespace scheduler;
+
+namespace {
+  /**
+   * The scalar recurrence, from the given position on. The operations
+   * are the ones of SimpleResource::reSchedule().
+   */
+  void evaluateFrom(const double* submitTimes, const double* runTimes,
+	  JobQueue& queue, const size_t first, double freetime) {
+	const JobQueue::JobListType& queuedJobs=queue.getJobs();
+	JobQueue::TimeListType& startTimes=queue.getStartTimeBuffer();
+	JobQueue::TimeListType& queueTimes=queue.getQueueTimeBuffer();
+	JobQueue::TimeListType& finishTimes=queue.getFinishTimeBuffer();
+	for (size_t i=first; i < queuedJobs.size(); i++) {
+	  double submittime=submitTimes[queuedJobs[i]];
+	  double starttime=(freetime < submittime) ? submittime : freetime;
+	  freetime=starttime + runTimes[queuedJobs[i]];
+	  startTimes[i]=starttime;
+	  queueTimes[i]=starttime - submittime;
+	  finishTimes[i]=freetime;
+	}
+  }
+
+  void finish(JobQueue& queue) {
+	const JobQueue::TimeListType& queueTimes=queue.getQueueTimes();
+	JobQueue::TimeSumType sum=0;
+	for (size_t i=0; i < queueTimes.size(); i++)
+	  sum += JobQueue::toFixed(queueTimes[i]);
+	queue.setEvaluated(sum);
+  }
+
+#ifdef FCFS_AVX2
+  /**
+   * Evaluates LANES queues up to the length of the shortest one, and
+   * the rest of each queue with the scalar loop. _mm256_max_pd(a, b)
+   * returns b unless a > b, which is the comparison of the scalar loop
+   * with a = submit time. Job indices are gathered as 32 bit ints.
+   */
+  __attribute__((target("avx2")))
+  void evaluateLanes(const double* submitTimes, const double* runTimes,
+	  JobQueue* const* queues) {
+	const Workload::IndexType* jobs[fcfs::LANES];
+	double* startTimes[fcfs::LANES];
+	double* queueTimes[fcfs::LANES];
+	double* finishTimes[fcfs::LANES];
+	size_t common=queues[0]->size();
+	for (size_t lane=1; lane < fcfs::LANES; lane++) {
+	  if (queues[lane]->size() < common)
+		common=queues[lane]->size();
+	}
+	__m256d freetime=_mm256_setzero_pd();
+	double start[fcfs::LANES], queued[fcfs::LANES], finished[fcfs::LANES];
+	if (common == 0) {
+	  for (size_t lane=0; lane < fcfs::LANES; lane++)
+		evaluateFrom(submitTimes, runTimes, *queues[lane], 0, 0.0);
+	  return;
+	}
+	for (size_t lane=0; lane < fcfs::LANES; lane++) {
+	  JobQueue& queue=*queues[lane];
+	  jobs[lane]=&queue.getJobs()[0];
+	  startTimes[lane]=&queue.getStartTimeBuffer()[0];
+	  queueTimes[lane]=&queue.getQueueTimeBuffer()[0];
+	  finishTimes[lane]=&queue.getFinishTimeBuffer()[0];
+	}
+	// the masked gathers with a defined source avoid a false warning
+	const __m256d zero=_mm256_setzero_pd();
+	const __m256d all=_mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+	for (size_t i=0; i < common; i++) {
+	  __m128i index=_mm_set_epi32(jobs[3][i], jobs[2][i], jobs[1][i], jobs[0][i]);
+	  __m256d submittime=_mm256_mask_i32gather_pd(zero, submitTimes, index, all, 8);
+	  __m256d runtime=_mm256_mask_i32gather_pd(zero, runTimes, index, all, 8);
+	  __m256d starttime=_mm256_max_pd(submittime, freetime);
+	  freetime=_mm256_add_pd(starttime, runtime);
+	  _mm256_storeu_pd(start, starttime);
+	  _mm256_storeu_pd(queued, _mm256_sub_pd(starttime, submittime));
+	  _mm256_storeu_pd(finished, freetime);
+	  for (size_t lane=0; lane < fcfs::LANES; lane++) {
+		startTimes[lane][i]=start[lane];
+		queueTimes[lane][i]=queued[lane];
+		finishTimes[lane][i]=finished[lane];
+	  }
+	}
+	_mm256_storeu_pd(finished, freetime);
+	for (size_t lane=0; lane < fcfs::LANES; lane++)
+	  evaluateFrom(submitTimes, runTimes, *queues[lane], common, finished[lane]);
+  }
+#endif
+}
+
+bool fcfs::hasAVX2() {
+#ifdef FCFS_AVX2
+  static const bool avx2=__builtin_cpu_supports("avx2");
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+void fcfs::evaluate(const scheduler::Workload& jobs,
+	scheduler::JobQueue* const* queues, const size_t count) {
+  const double* submitTimes=jobs.getSubmitTimeColumn();
+  const double* runTimes=jobs.getRunTimeColumn();
+  size_t i=0;
+#ifdef FCFS_AVX2
+  // gathers take signed 32 bit indices
+  if (hasAVX2() && jobs.size() <= 0x7fffffffUL) {
+	for ( ; i + LANES <= count; i += LANES) {
+	  evaluateLanes(submitTimes, runTimes, queues + i);
+	  for (size_t lane=0; lane < LANES; lane++)
+		finish(*queues[i + lane]);
+	}
+  }
+#endif
+  for ( ; i < count; i++) {
+	evaluateFrom(submitTimes, runTimes, *queues[i], 0, 0.0);
+	finish(*queues[i]);
+  }
+}
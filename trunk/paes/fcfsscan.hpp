@@ -0,0 +1,34 @@
+#ifndef PAES_FCFSSCAN_HPP
+#define PAES_FCFSSCAN_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <jobqueue.hpp>
+
+namespace scheduler {
+  /**
+   * Full evaluation of FCFS queues on a single machine, as done by
+   * SimpleResource: start = max(free time, submit time), free time =
+   * start + runtime.
+   *
+   * The recurrence of one queue is a chain of dependent operations, and
+   * a parallel prefix formulation would add up the runtimes in another
+   * order and round differently. Instead, the AVX2 kernel evaluates
+   * LANES queues side by side, one per vector lane, with the same
+   * operations in the same order as the scalar loop. The results are
+   * identical, only the chains overlap. The kernel is selected at run
+   * time if the CPU supports AVX2, otherwise the queues are evaluated
+   * one after the other.
+   */
+  namespace fcfs {
+	static const size_t LANES = 4;
+	/**
+	 * Evaluates all jobs of the queues and marks them as evaluated.
+	 */
+	void evaluate(const scheduler::Workload& jobs,
+		scheduler::JobQueue* const* queues, const size_t count);
+	bool hasAVX2();
+  }
+}
+
+#endif /* PAES_FCFSSCAN_HPP */
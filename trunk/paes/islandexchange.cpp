@@ -0,0 +1,161 @@
+#include "islandexchange.hpp"
+#include <config.hpp>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+using namespace scheduler;
+
+IslandExchange::IslandExchange (const std::string& directory, const unsigned int islandID,
+	const unsigned int islands, const scheduler::Workload::Ptr& workload,
+	const scheduler::ResourcePool::Ptr& resources) :
+  _directory(directory), _islandID(islandID), _islands(islands),
+  _workload(workload), _resources(resources), _generation(0),
+  _importedGenerations(), _mutex()
+{
+  removeFile(getFilename(_islandID, "migrants"));
+  removeFile(getFilename(_islandID, "final"));
+  if (_islandID == 0)
+	removeFile(getLockname());
+}
+
+const std::string IslandExchange::getFilename(const unsigned int islandID, const std::string& kind) {
+  std::ostringstream oss;
+  oss << _directory << "/island-" << islandID << "-" << kind << ".txt";
+  return oss.str();
+}
+
+const std::string IslandExchange::getLockname() {
+  return _directory + "/island-merge.lock";
+}
+
+void IslandExchange::removeFile(const std::string& filename) {
+  if (unlink(filename.c_str()) != 0 && errno != ENOENT)
+	std::cerr << "Unable to remove stale file " << filename << std::endl;
+}
+
+void IslandExchange::writeSchedules(const std::string& filename,
+	const std::vector<scheduler::Schedule::Ptr>& schedules) {
+  std::string tmpname(filename + ".tmp");
+  std::ofstream myfile (tmpname.c_str());
+  if (! myfile.is_open()) {
+	std::cerr << "Unable to open file " << tmpname << ", skipping migration" << std::endl;
+	return;
+  }
+  _generation++;
+  myfile << "# generation " << _generation << " island " << _islandID;
+  myfile << " schedules " << schedules.size() << std::endl;
+  std::vector<scheduler::Schedule::Ptr>::const_iterator it;
+  for(  it = schedules.begin(); it < schedules.end(); it++) {
+	const Schedule::AssignmentType& assignment=(*it)->getAssignment();
+	for (size_t i=0; i < assignment.size(); i++) {
+	  if (i > 0)
+		myfile << " ";
+	  myfile << assignment[i];
+	}
+	myfile << std::endl;
+  }
+  myfile.close();
+  if (rename(tmpname.c_str(), filename.c_str()) != 0)
+	std::cerr << "Unable to rename " << tmpname << " to " << filename << std::endl;
+}
+
+unsigned long IslandExchange::readSchedules(const std::string& filename,
+	std::vector<scheduler::Schedule::Ptr>& schedules,
+	const unsigned long knownGeneration) {
+  std::ifstream myfile (filename.c_str());
+  if (! myfile.is_open())
+	return 0;
+  std::string line;
+  unsigned long generation=0;
+  if (getline(myfile, line)) {
+	std::istringstream iss(line);
+	std::string hash, keyword;
+	iss >> hash >> keyword >> generation;
+  }
+  if (generation == knownGeneration)
+	return generation;
+  unsigned long lineNumber=1;
+  while (getline(myfile, line)) {
+	lineNumber++;
+	if (line.empty() || line[0] == '#')
+	  continue;
+	std::istringstream iss(line);
+	Schedule::AssignmentType assignment;
+	assignment.reserve(_workload->size());
+	scheduler::Resource::IDType resourceID;
+	while (iss >> resourceID)
+	  assignment.push_back(resourceID);
+	Schedule::Ptr schedule(new Schedule(_workload, _resources));
+	try {
+	  schedule->setAssignment(assignment);
+	} catch (std::invalid_argument& e) {
+	  std::cerr << filename << ":" << lineNumber << ": " << e.what() << " - skipping." << std::endl;
+	  continue;
+	}
+	schedule->update();
+	schedules.push_back(schedule);
+  }
+  return generation;
+}
+
+void IslandExchange::emigrate(const std::vector<scheduler::Schedule::Ptr>& front) {
+  std::vector<scheduler::Schedule::Ptr> migrants;
+  size_t count = front.size() < config::MIGRATION_SIZE ? front.size() : config::MIGRATION_SIZE;
+  for (size_t i=0; i < count; i++) {
+	// evenly spaced, always including both ends of the front
+	size_t index = (count > 1) ? (i * (front.size() - 1)) / (count - 1) : 0;
+	migrants.push_back(front[index]);
+  }
+  util::ScopedLock lock(_mutex);
+  writeSchedules(getFilename(_islandID, "migrants"), migrants);
+}
+
+std::vector<scheduler::Schedule::Ptr> IslandExchange::immigrate() {
+  std::vector<scheduler::Schedule::Ptr> retval;
+  util::ScopedLock lock(_mutex);
+  for (unsigned int island=0; island < _islands; island++) {
+	if (island == _islandID)
+	  continue;
+	std::vector<scheduler::Schedule::Ptr> migrants;
+	unsigned long generation=readSchedules(getFilename(island, "migrants"), migrants,
+		_importedGenerations[island]);
+	if (generation == 0 || generation == _importedGenerations[island])
+	  continue;
+	_importedGenerations[island]=generation;
+	retval.insert(retval.end(), migrants.begin(), migrants.end());
+  }
+  return retval;
+}
+
+void IslandExchange::writeFinal(const scheduler::ScheduleArchive::Ptr& archive) {
+  util::ScopedLock lock(_mutex);
+  writeSchedules(getFilename(_islandID, "final"), archive->getSortedSchedules());
+}
+
+bool IslandExchange::mergeFinal(const scheduler::ScheduleArchive::Ptr& archive) {
+  for (unsigned int island=0; island < _islands; island++) {
+	struct stat st;
+	if (stat(getFilename(island, "final").c_str(), &st) != 0)
+	  return false;
+  }
+  // Only one island merges.
+  int fd=open(getLockname().c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+  if (fd < 0)
+	return false;
+  close(fd);
+  for (unsigned int island=0; island < _islands; island++) {
+	std::vector<scheduler::Schedule::Ptr> schedules;
+	readSchedules(getFilename(island, "final"), schedules);
+	std::vector<scheduler::Schedule::Ptr>::iterator it;
+	for(  it = schedules.begin(); it < schedules.end(); it++) {
+	  archive->archiveSchedule(*it);
+	}
+  }
+  return true;
+}
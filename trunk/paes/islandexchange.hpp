@@ -0,0 +1,92 @@
+#ifndef PAES_ISLANDEXCHANGE_HPP
+#define PAES_ISLANDEXCHANGE_HPP 1
+
+#include <common.hpp>
+#include <schedule.hpp>
+#include <schedulearchive.hpp>
+#include <workload.hpp>
+#include <resourcepool.hpp>
+#include <mutex.hpp>
+#include <vector>
+#include <map>
+
+namespace scheduler {
+  /**
+   * Exchanges schedules between several paes-scheduler processes (the
+   * islands) that share one output directory. Every island regularly
+   * writes a sample of its archive to island-<id>-migrants.txt and
+   * archives the schedules the other islands wrote. At the end each
+   * island writes its whole archive to island-<id>-final.txt; the last
+   * island to finish merges all final archives into one front.
+   *
+   * Files are written to a temporary name and renamed, so readers
+   * never see partial files. Each line of a file is one schedule: the
+   * resource ids of all jobs in job index order.
+   *
+   * Files left in the directory by an earlier run would be taken for
+   * this run's, so on construction every island removes its own files
+   * and island 0 the merge lock. The islands of a run must therefore be
+   * started before the first of them finishes.
+   *
+   * The exchange does not touch the archive while migrating, so the
+   * caller only needs to hold the archive lock to take the front and to
+   * archive the immigrants. Several workers may migrate at once.
+   */
+  class IslandExchange {
+	public:
+	  typedef std::tr1::shared_ptr<IslandExchange> Ptr;
+	  IslandExchange (const std::string& directory, const unsigned int islandID,
+		  const unsigned int islands, const scheduler::Workload::Ptr& workload,
+		  const scheduler::ResourcePool::Ptr& resources);
+	  virtual ~IslandExchange() {};
+	  unsigned int getIslandID() const { return _islandID; };
+	  unsigned int getIslands() const { return _islands; };
+	  /**
+	   * Publishes up to config::MIGRATION_SIZE schedules, spread evenly
+	   * over the front, see ScheduleArchive::getSortedSchedules().
+	   */
+	  void emigrate(const std::vector<scheduler::Schedule::Ptr>& front);
+	  /**
+	   * Returns the schedules published by the other islands since the
+	   * last call, already evaluated.
+	   */
+	  std::vector<scheduler::Schedule::Ptr> immigrate();
+	  /**
+	   * Publishes the complete archive of this island.
+	   */
+	  void writeFinal(const scheduler::ScheduleArchive::Ptr& archive);
+	  /**
+	   * If the final archives of all islands are present and no other
+	   * island has started merging, archives all of them in the given
+	   * archive and returns true.
+	   */
+	  bool mergeFinal(const scheduler::ScheduleArchive::Ptr& archive);
+
+	private:
+	  IslandExchange (const IslandExchange& original);
+	  IslandExchange& operator= (const IslandExchange& rhs);
+	  const std::string getFilename(const unsigned int islandID, const std::string& kind);
+	  const std::string getLockname();
+	  void removeFile(const std::string& filename);
+	  void writeSchedules(const std::string& filename,
+		  const std::vector<scheduler::Schedule::Ptr>& schedules);
+	  /**
+	   * Reads a schedule file, returns its generation or 0 if there is
+	   * no such file. The schedules are only read if the generation
+	   * differs from knownGeneration.
+	   */
+	  unsigned long readSchedules(const std::string& filename,
+		  std::vector<scheduler::Schedule::Ptr>& schedules,
+		  const unsigned long knownGeneration = 0);
+	  std::string _directory;
+	  unsigned int _islandID;
+	  unsigned int _islands;
+	  scheduler::Workload::Ptr _workload;
+	  scheduler::ResourcePool::Ptr _resources;
+	  unsigned long _generation;
+	  std::map<unsigned int, unsigned long> _importedGenerations;
+	  util::Mutex _mutex;
+  };
+}
+
+#endif /* PAES_ISLANDEXCHANGE_HPP */
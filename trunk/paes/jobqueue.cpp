@@ -0,0 +1,85 @@
+#include "jobqueue.hpp"
+#include <algorithm>
+#include <taintedstateexception.hpp>
+
+using namespace scheduler;
+
+// 2^20, about a microsecond
+const double JobQueue::TIME_SCALE = 1048576.0;
+
+/**
+ * Copies are made to be modified - reserve room for one more job so
+ * the following addJob() does not reallocate.
+ */
+JobQueue::JobQueue (const JobQueue& original) :
+  _jobs(), _startTimes(), _queueTimes(), _finishTimes(),
+  _calendar(original._calendar),
+  _firstChanged(original._firstChanged),
+  _changedEnd(original._changedEnd),
+  _tainted(original._tainted),
+  _queueTimeSum(original._queueTimeSum)
+{
+  size_t capacity=original._jobs.size()+1;
+  _jobs.reserve(capacity);
+  _jobs.assign(original._jobs.begin(), original._jobs.end());
+  _startTimes.reserve(capacity);
+  _startTimes.assign(original._startTimes.begin(), original._startTimes.end());
+  _queueTimes.reserve(capacity);
+  _queueTimes.assign(original._queueTimes.begin(), original._queueTimes.end());
+  _finishTimes.reserve(capacity);
+  _finishTimes.assign(original._finishTimes.begin(), original._finishTimes.end());
+}
+
+void JobQueue::addJob(const scheduler::Workload::IndexType& jobIndex) {
+  JobListType::iterator it=std::lower_bound(_jobs.begin(), _jobs.end(), jobIndex);
+  if (it == _jobs.end() || (*it) != jobIndex) {
+	size_t position=it - _jobs.begin();
+	_jobs.insert(it, jobIndex);
+	_startTimes.insert(_startTimes.begin() + position, 0.0);
+	_queueTimes.insert(_queueTimes.begin() + position, 0.0);
+	_finishTimes.insert(_finishTimes.begin() + position, 0.0);
+	_calendar.insertPosition(position);
+	_firstChanged=std::min(_firstChanged, position);
+	if (position < _changedEnd)
+	  _changedEnd++;
+	_changedEnd=std::max(_changedEnd, position + 1);
+  }
+  _tainted=true;
+}
+
+void JobQueue::removeJob(const scheduler::Workload::IndexType& jobIndex) {
+  JobListType::iterator it=std::lower_bound(_jobs.begin(), _jobs.end(), jobIndex);
+  if (it != _jobs.end() && (*it) == jobIndex) {
+	size_t position=it - _jobs.begin();
+	_queueTimeSum -= toFixed(_queueTimes[position]);
+	_jobs.erase(it);
+	_startTimes.erase(_startTimes.begin() + position);
+	_queueTimes.erase(_queueTimes.begin() + position);
+	_finishTimes.erase(_finishTimes.begin() + position);
+	_calendar.erasePosition(position);
+	_firstChanged=std::min(_firstChanged, position);
+	// the job now at the position has a new predecessor
+	if (position < _changedEnd)
+	  _changedEnd--;
+	_changedEnd=std::max(_changedEnd, position);
+  }
+  _tainted=true;
+}
+
+void JobQueue::setEvaluated() {
+  _firstChanged=_jobs.size();
+  _changedEnd=0;
+  _tainted=false;
+}
+
+void JobQueue::setEvaluated(const TimeSumType& queueTimeSum) {
+  _queueTimeSum=queueTimeSum;
+  setEvaluated();
+}
+
+JobQueue::TimeSumType JobQueue::getQueueTimeSum() {
+  if (! _tainted)
+	return _queueTimeSum;
+  else
+	throw TaintedStateException("Tainted: No up-to-date total QT available.");
+}
@@ -0,0 +1,123 @@
+#ifndef PAES_JOBQUEUE_HPP
+#define PAES_JOBQUEUE_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <reservationcalendar.hpp>
+#include <vector>
+#include <stdint.h>
+#include <math.h>
+
+namespace scheduler {
+  /**
+   * The jobs a schedule assigns to one resource, together with the
+   * cached evaluation results of that resource. A mutated schedule
+   * shares all queues with its original and copies only the queues it
+   * modifies, so only these need to be evaluated again.
+   *
+   * The start, queue and finish time of each job are kept in buffers
+   * at the same position as the job. The buffers grow and shrink with
+   * the queue, so evaluating a queue never allocates memory.
+   *
+   * The queue remembers the positions whose jobs changed since the
+   * last evaluation. Resources whose results for a job depend only on
+   * the jobs before it may keep everything before the first change.
+   *
+   * The total queue time is a running sum in fixed point, in units of
+   * 1/TIME_SCALE seconds, updated whenever a job's times are set or the
+   * job is removed. Like the price sum of the schedule it is exact, so
+   * re-evaluating only part of the queue gives the same total as a
+   * full evaluation.
+   */
+  class JobQueue {
+	public:
+	  typedef std::tr1::shared_ptr<JobQueue> Ptr;
+	  typedef std::vector<scheduler::Workload::IndexType> JobListType;
+	  typedef std::vector<double> TimeListType;
+	  typedef int64_t FixedTimeType;
+	  typedef __int128 TimeSumType;
+	  static const double TIME_SCALE;
+	  JobQueue () :
+		_jobs(), _startTimes(), _queueTimes(), _finishTimes(),
+		_calendar(), _firstChanged(0), _changedEnd(0), _tainted(true),
+		_queueTimeSum(0) {};
+	  JobQueue (const JobQueue& original);
+	  virtual ~JobQueue() {};
+	  /**
+	   * Inserts/removes a job, keeping the queue sorted by job index.
+	   */
+	  void addJob(const scheduler::Workload::IndexType& jobIndex);
+	  void removeJob(const scheduler::Workload::IndexType& jobIndex);
+	  size_t size() const { return _jobs.size(); };
+	  const JobListType& getJobs() const { return _jobs; };
+	  const TimeListType& getStartTimes() const { return _startTimes; };
+	  const TimeListType& getQueueTimes() const { return _queueTimes; };
+	  const TimeListType& getFinishTimes() const { return _finishTimes; };
+	  /**
+	   * Writable buffers for evaluations that set the times of all jobs
+	   * at once. They must finish with setEvaluated(queueTimeSum).
+	   */
+	  TimeListType& getStartTimeBuffer() { return _startTimes; };
+	  TimeListType& getQueueTimeBuffer() { return _queueTimes; };
+	  TimeListType& getFinishTimeBuffer() { return _finishTimes; };
+	  /**
+	   * Stores the evaluation results of the job at the position and
+	   * updates the total queue time.
+	   */
+	  void setTimes(const size_t position, const double startTime,
+		  const double queueTime, const double finishTime) {
+		_queueTimeSum += toFixed(queueTime) - toFixed(_queueTimes[position]);
+		_startTimes[position]=startTime;
+		_queueTimes[position]=queueTime;
+		_finishTimes[position]=finishTime;
+	  };
+	  /**
+	   * The node reservations of the queued jobs. Only resources that use
+	   * them activate the calendar, see ConservativeResource.
+	   */
+	  ReservationCalendar& getCalendar() { return _calendar; };
+	  /**
+	   * The first position whose job was added or removed since the last
+	   * evaluation, size() if there was none.
+	   */
+	  size_t getFirstChanged() const { return _firstChanged; };
+	  /**
+	   * The jobs from this position on were not changed since the last
+	   * evaluation and still have its results. Jobs before them may
+	   * have, so a job from here on whose start time is the cached one
+	   * leaves all following jobs unchanged as well.
+	   */
+	  size_t getChangedEnd() const { return _changedEnd; };
+	  /**
+	   * True if no job has a cached result, e.g. for a new queue.
+	   */
+	  bool needsFullEvaluation() const {
+		return _firstChanged == 0 && _changedEnd == _jobs.size();
+	  };
+	  bool isTainted() const { return _tainted; };
+	  /**
+	   * Marks the queue as up to date after all changed jobs got their
+	   * times. Prices are summed up by the schedule, see PriceTable.
+	   */
+	  void setEvaluated();
+	  void setEvaluated(const TimeSumType& queueTimeSum);
+	  TimeSumType getQueueTimeSum();
+	  double getTotalQueueTime() { return toDouble(getQueueTimeSum()); };
+	  static FixedTimeType toFixed(const double time) { return llround(time * TIME_SCALE); };
+	  static double toDouble(const TimeSumType& sum) { return sum / TIME_SCALE; };
+
+	private:
+	  JobQueue& operator= (const JobQueue& rhs);
+	  JobListType _jobs;
+	  TimeListType _startTimes;
+	  TimeListType _queueTimes;
+	  TimeListType _finishTimes;
+	  ReservationCalendar _calendar;
+	  size_t _firstChanged;
+	  size_t _changedEnd;
+	  bool _tainted;
+	  TimeSumType _queueTimeSum;
+  };
+}
+
+#endif /* PAES_JOBQUEUE_HPP */
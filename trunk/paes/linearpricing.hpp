@@ -13,8 +13,9 @@ namespace scheduler {
 	  LinearPricing (const double basePrice, const double timePrice) : _basePrice(basePrice), _timePrice(timePrice) {};
 	  virtual ~LinearPricing() {};
 
-	  double getPrice(scheduler::Job::Ptr job) {
-		return (_basePrice + _timePrice * job->getRunTime());
+	  double getPrice(const scheduler::Workload& workload,
+		  const scheduler::Workload::IndexType& jobIndex) const {
+		return (_basePrice + _timePrice * workload.getRunTime(jobIndex));
 	  }
 
 	  const std::string str() {
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <unistd.h>
+#include <getopt.h>
 #include <vector>
 #include <sstream>
 #include <stdio.h>
@@ -7,11 +8,11 @@
 #include <sys/stat.h>
 #include <sys/types.h> /* various type definitions, like pid_t           */
 #include <signal.h>    /* signal name macros, and the signal() prototype */
-#include <sys/time.h>  /* gettimeofday and friends.						 */
 
 #include <resourcepool.hpp>
 #include <common.hpp>
 #include <config.hpp>
+#include <experimentconfig.hpp>
 #include <workload.hpp>
 #include <random.hpp>
 #include <job.hpp>
@@ -21,6 +22,12 @@
 #include <reportwriter.hpp>
 #include <schedulearchive.hpp>
 #include <linearpricing.hpp>
+#include <optimizer.hpp>
+#include <islandexchange.hpp>
+#include <checkpoint.hpp>
+#include <clock.hpp>
+#include <telemetry.hpp>
+#include <taskpool.hpp>
 
 // Global variables
 util::ReportWriter::Ptr iterationReporter;
@@ -33,8 +40,17 @@ void printHelp() {
   std::cout << "Mandatory commandline parameters:" << std::endl;
   std::cout << " -i <FILE>: Specify input file" << std::endl;
   std::cout << " -o <DIR>: Specify output directory" << std::endl;
-  std::cout << " -s <UINT>: Specify RNG seed value" << std::endl;
+  std::cout << " -s <UINT>: Specify RNG seed value, island n uses the value + n" << std::endl;
+  std::cout << " -c <FILE>: Experiment definition file (default: compile-time configuration)" << std::endl;
   std::cout << " -n <INT>: Set number of iterations (default 10,000,000)" << std::endl;
+  std::cout << " -j <UINT>: Number of worker threads (default 1)" << std::endl;
+  std::cout << " -e <UINT>: Threads for evaluating large schedules, e.g. the initial one (default 1)" << std::endl;
+  std::cout << " -l <UINT>: Mutants per generation, (1+l)-PAES (default 1)" << std::endl;
+  std::cout << " -N <UINT>: Number of islands sharing the output directory (default 1)" << std::endl;
+  std::cout << " -I <UINT>: Island id of this process, 0 .. N-1 (default 0)" << std::endl;
+  std::cout << " -m <UINT>: Migrate schedules every m iterations (default " << config::MIGRATION_INTERVAL << ")" << std::endl;
+  std::cout << " -k <UINT>: Write a checkpoint every k iterations and at the end, needs -j 1 and -N 1 (default: no checkpoints)" << std::endl;
+  std::cout << " --resume: Continue from the checkpoint in the output directory, if there is one" << std::endl;
   std::cout << " -v: Verbose output" << std::endl;
 }
 
@@ -46,39 +62,36 @@ void saveResults() {
   iterationReporter->writeReport();
 }
 
-/* signal handler */
+volatile sig_atomic_t interrupted = 0;
+
+/* signal handler: only flags the interruption. The main loop stops at
+ * the next generation, then the checkpoint and the results are written
+ * outside of the handler. A second signal terminates at once. */
 void catch_int(int sig_num) {
+  if (interrupted) {
+	signal(sig_num, SIG_DFL);
+	raise(sig_num);
+	return;
+  }
   /* re-set the signal handler again to catch_int, for next time */
   signal(sig_num, catch_int);
-  /* and print the message */
-  std::cout << "Caught signal ";
-  switch (sig_num) {
-	case SIGINT:
-	  std::cout << "SIGINT - shutting down." << std::endl;
-	  break;
-	case SIGSEGV:
-	  std::cout << "SIGSEGV - attempting to save data." << std::endl;
-	  break;
-	default:
-	  std::cout << "UNKNOWN: " << sig_num << std::endl;
-	  break;
-  }
-  saveResults();
-  util::RNG& rng=util::RNG::instance();
-  std::cout << "RNG seed value was " << rng.get_seed() << std::endl;
-  exit(-2);
+  interrupted = 1;
+}
+
+/* After a segfault, no state is worth saving - the last checkpoint is. */
+void catch_segv(int sig_num) {
+  static const char message[] = "Caught SIGSEGV - the last checkpoint can be resumed.\n";
+  ssize_t written=write(STDERR_FILENO, message, sizeof(message) - 1);
+  (void) written;
+  signal(sig_num, SIG_DFL);
+  raise(sig_num);
 }
 
 /* Registers our routine as signal handler */
 void register_inthandlers() {
   signal(SIGINT, catch_int);
-  signal(SIGSEGV, catch_int);
-}
-
-long getCurrentMilliseconds() {
-  struct timeval tv;
-  gettimeofday (&tv, NULL);
-  return (((long)tv.tv_sec * 1000) + (tv.tv_usec / 1000));
+  signal(SIGTERM, catch_int);
+  signal(SIGSEGV, catch_segv);
 }
 
 int main (int argc, char** argv) {
@@ -87,13 +100,26 @@ int main (int argc, char** argv) {
   char *inputfile = NULL;
   char *outputdir = NULL;
   char *rng_seed_str = NULL;
+  char *experimentfile = NULL;
   unsigned int max_iterations = 0;
+  unsigned int threads = 1;
+  unsigned int evaluation_threads = 1;
+  unsigned int mutants = 1;
+  unsigned int islands = 1;
+  unsigned int island_id = 0;
+  unsigned long migration_interval = config::MIGRATION_INTERVAL;
+  unsigned long checkpoint_interval = 0;
+  bool resume = false;
+  static struct option long_options[] = {
+	{"resume", no_argument, NULL, 'r'},
+	{NULL, 0, NULL, 0}
+  };
   int c;
 
   register_inthandlers();
 
   opterr = 0;
-  while ((c = getopt (argc, argv, "hvi:o:s:n:")) != -1)
+  while ((c = getopt_long (argc, argv, "hvi:o:s:c:n:j:e:l:N:I:m:k:", long_options, NULL)) != -1)
 	switch (c) {
 	  case 'h':
 		printHelp();
@@ -111,15 +137,65 @@ int main (int argc, char** argv) {
 	  case 's':
 		rng_seed_str = optarg;
 		break;
+	  case 'c':
+		experimentfile = optarg;
+		break;
     case 'n':
     sscanf(optarg, "%u", &max_iterations);
     break;
+	  case 'j':
+		if (sscanf(optarg, "%u", &threads) != 1 || threads == 0) {
+		  std::cerr << "Invalid number of threads " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'e':
+		if (sscanf(optarg, "%u", &evaluation_threads) != 1 || evaluation_threads == 0) {
+		  std::cerr << "Invalid number of evaluation threads " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'l':
+		if (sscanf(optarg, "%u", &mutants) != 1 || mutants == 0) {
+		  std::cerr << "Invalid number of mutants " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'N':
+		if (sscanf(optarg, "%u", &islands) != 1 || islands == 0) {
+		  std::cerr << "Invalid number of islands " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'I':
+		if (sscanf(optarg, "%u", &island_id) != 1) {
+		  std::cerr << "Invalid island id " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'm':
+		if (sscanf(optarg, "%lu", &migration_interval) != 1 || migration_interval == 0) {
+		  std::cerr << "Invalid migration interval " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'k':
+		if (sscanf(optarg, "%lu", &checkpoint_interval) != 1 || checkpoint_interval == 0) {
+		  std::cerr << "Invalid checkpoint interval " << optarg << " - aborting." << std::endl;
+		  exit(-1);
+		}
+		break;
+	  case 'r':
+		resume = true;
+		break;
 	  case '?':
 		if (optopt == 'i')
 		  fprintf (stderr, "Option -%c requires an argument.\n", optopt);
 		else if (optopt == 'o')
 		  fprintf (stderr, "Option -%c requires an argument.\n", optopt);
-		else if (optopt == 's')
+		else if (optopt == 's' || optopt == 'c')
+		  fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+		else if (optopt == 'n' || optopt == 'j' || optopt == 'e' || optopt == 'l' || optopt == 'N' || optopt == 'I' || optopt == 'm' || optopt == 'k')
 		  fprintf (stderr, "Option -%c requires an argument.\n", optopt);
 		else if (isprint (optopt))
 		  fprintf (stderr, "Unknown option `-%c'.\n", optopt);
@@ -153,16 +229,49 @@ int main (int argc, char** argv) {
 	}
   }
 
+  // A checkpoint holds the state of one worker and one island.
+  if ((checkpoint_interval > 0 || resume) && (threads > 1 || islands > 1)) {
+	std::cerr << "Checkpoints (-k, --resume) need -j 1 and -N 1 - aborting." << std::endl;
+	exit(-1);
+  }
+
+  util::TaskPool::instance().setThreads(evaluation_threads);
+  if (evaluation_threads > 1)
+	std::cout << "Evaluating large schedules with " << evaluation_threads << " threads." << std::endl;
+
+  if (island_id >= islands) {
+	std::cerr << "Island id " << island_id << " is not below the number of islands " << islands << " - aborting." << std::endl;
+	exit(-1);
+  }
+  // Every island writes its reports to its own subdirectory, the
+  // exchange files and the merged results live in the output directory.
+  std::string islanddir(outputdir);
+  if (islands > 1) {
+	std::ostringstream islanddir_oss;
+	islanddir_oss << outputdir << "/island-" << island_id;
+	islanddir=islanddir_oss.str();
+	struct stat st;
+	if (stat(islanddir.c_str(), &st) != 0 && mkdir(islanddir.c_str(), 0755) != 0) {
+	  std::cout << "Cannot create island directory \"" << islanddir << "\" - aborting." << std::endl;
+	  exit(-2);
+	}
+	std::cout << "Island " << island_id << " of " << islands << ", writing reports to " << islanddir << std::endl;
+  }
+
   if (rng_seed_str == NULL) {
 	std::cout << "Using random RNG seed: ";
 	util::RNG& rng=util::RNG::instance();
+	// Islands started at the same time must not share a seed.
+	if (island_id > 0)
+	  rng.set_seed(rng.get_seed() + island_id);
 	std::cout << rng.get_seed() << std::endl;
   } else {
 	unsigned int seed_value=0;
 	std::istringstream convertStream(rng_seed_str);
 	if (convertStream>>seed_value) {
 	  util::RNG& rng=util::RNG::instance();
-	  rng.set_seed(seed_value);
+	  // Each island searches with its own seed, island 0 with the given one.
+	  rng.set_seed(seed_value + island_id);
 	  std::cout << "RNG seed value set to " << rng.get_seed() << std::endl;
 	} else {
 	  std::cout << "Cannot convert seed value " << rng_seed_str << " to uint. Abort." << std::endl;
@@ -170,12 +279,22 @@ int main (int argc, char** argv) {
 	}
   }
 
+  config::ExperimentConfig::Ptr experiment(new config::ExperimentConfig());
+  if (experimentfile != NULL) {
+	try {
+	  experiment=config::ExperimentConfig::load(experimentfile);
+	} catch (const std::exception& e) {
+	  std::cerr << e.what() << " - aborting." << std::endl;
+	  exit(-1);
+	}
+  }
+
   if (max_iterations == 0) {
-    max_iterations = config::MAX_ITERATION;
+    max_iterations = experiment->getMaxIterations();
   }
 
-  std::string configInfo(config::getConfigString());
-  std::cout << "Compile-time configuration is: " << std::endl << configInfo << std::endl;
+  std::string configInfo(experiment->str());
+  std::cout << "Experiment configuration is: " << std::endl << configInfo << std::endl;
 
   // Load Workload.
   scheduler::FileWorkloadFactory fwFactory(inputfile);
@@ -193,30 +312,74 @@ int main (int argc, char** argv) {
   }
 
   // Build Resources.
-  scheduler::ResourcePool::Ptr resources=config::createResourcePool();
+  scheduler::ResourcePool::Ptr resources;
+  try {
+	resources=experiment->createResourcePool();
+  } catch (const std::exception& e) {
+	std::cerr << e.what() << " - aborting." << std::endl;
+	exit(-1);
+  }
 
   // Archive for the schedules.
-  archive = scheduler::ScheduleArchive::Ptr (new scheduler::ScheduleArchive(config::ARCHIVE_SIZE, workload->size()));
+  archive = scheduler::ScheduleArchive::Ptr (new scheduler::ScheduleArchive(experiment->getArchiveSize(),
+	  workload->size(), experiment->getLocationBits()));
+
+  // Continue an earlier run from its checkpoint.
+  std::string checkpointFile(islanddir + "/checkpoint.bin");
+  scheduler::Checkpoint::Ptr checkpoint;
+  struct stat checkpoint_st;
+  if (resume && stat(checkpointFile.c_str(), &checkpoint_st) == 0) {
+	try {
+	  checkpoint=scheduler::Checkpoint::read(checkpointFile, workload, resources, experiment);
+	} catch (const std::exception& e) {
+	  std::cerr << e.what() << " - aborting." << std::endl;
+	  exit(-1);
+	}
+	std::cout << "Resuming from " << checkpointFile << " at iteration " << checkpoint->getLoopState().iteration << std::endl;
+  } else if (resume) {
+	std::cout << "No checkpoint " << checkpointFile << " - starting a new run." << std::endl;
+  }
 
   // 1. generate initial random solution c and add it to the archive
   scheduler::Schedule::Ptr current(new scheduler::Schedule(workload, resources));
-  std::cout << "# Generating Random schedule " << std::endl;
-  current->randomSchedule();
-  current->update(); 
-  resources->sanityCheck();
-  archive->archiveSchedule(current);
+  if (! checkpoint) {
+	std::cout << "# Generating Random schedule " << std::endl;
+	current->randomSchedule();
+	current->update(); 
+	current->sanityCheck();
+	archive->archiveSchedule(current);
+  }
 
   // prepare reporting
-  unsigned long archivedSolutions=0;
   unsigned long report_interval = max_iterations / 3;
   std::cout << "Will dump intermediate report every "<<report_interval << " iterations." << std::endl;
   std::ostringstream iteration_oss;
-  iteration_oss << outputdir << "/runtime-report.txt";
-  iterationReporter = util::ReportWriter::Ptr(new util::ReportWriter(iteration_oss.str()));
-  iterationReporter->addHeaderLine("Reporting runtime information below");
-  iterationReporter->addReportLine("it\tacc\tsize\tdistance");
+  iteration_oss << islanddir << "/runtime-report.txt";
+  std::ostringstream threads_oss;
+  threads_oss << "Worker threads: " << threads;
+  if (evaluation_threads > 1)
+	threads_oss << ", evaluation threads: " << evaluation_threads;
+  std::ostringstream mutants_oss;
+  mutants_oss << "Mutants per generation: " << mutants;
+  if (checkpoint) {
+	// continue the report as it was at the checkpoint
+	struct stat report_st;
+	if (stat(iteration_oss.str().c_str(), &report_st) != 0 ||
+		(uint64_t) report_st.st_size < checkpoint->getReportSize()) {
+	  std::cerr << "Runtime report " << iteration_oss.str() << " is shorter than recorded in the checkpoint - aborting." << std::endl;
+	  exit(-1);
+	}
+	iterationReporter = util::ReportWriter::Ptr(new util::ReportWriter(iteration_oss.str(),
+		  checkpoint->getReportSize()));
+  } else {
+	iterationReporter = util::ReportWriter::Ptr(new util::ReportWriter(iteration_oss.str()));
+	iterationReporter->addHeaderLine("Reporting runtime information below");
+	iterationReporter->addHeaderLine(threads_oss.str());
+	iterationReporter->addHeaderLine(mutants_oss.str());
+	iterationReporter->addReportLine("it\tacc\tsize\tdistance\tevals/s" + util::telemetry::getColumnHeader());
+  }
 
-  absReporter=util::ReportWriter::Ptr(new util::ReportWriter(std::string(outputdir)+"/absolute-results.txt"));
+  absReporter=util::ReportWriter::Ptr(new util::ReportWriter(islanddir+"/absolute-results.txt"));
   std::string headerLine("experiment from input file ");
   absReporter->addHeaderLine(headerLine + inputfile);
   std::string resourceInfo(resources->str());
@@ -228,136 +391,117 @@ int main (int argc, char** argv) {
   oss2 << "Workload size: " << workload->size();
   absReporter->addHeaderLine(oss2.str());
   std::ostringstream oss3;
-  oss3 << "Compile-time config: " << configInfo;
+  oss3 << "Experiment config: " << configInfo;
   absReporter->addHeaderLine(oss3.str());
+  absReporter->addHeaderLine(threads_oss.str());
+  absReporter->addHeaderLine(mutants_oss.str());
+  std::ostringstream island_oss;
+  island_oss << "Island: " << island_id << " of " << islands;
+  if (islands > 1)
+	absReporter->addHeaderLine(island_oss.str());
 
-  relReporter=util::ReportWriter::Ptr (new util::ReportWriter(std::string(outputdir)+"/relative-results.txt"));
+  relReporter=util::ReportWriter::Ptr (new util::ReportWriter(islanddir+"/relative-results.txt"));
   relReporter->addHeaderLine(headerLine + inputfile);
   relReporter->addHeaderLine(resourceInfo);
   relReporter->addHeaderLine(oss1.str());
   relReporter->addHeaderLine(oss2.str());
   relReporter->addHeaderLine(oss3.str());
+  relReporter->addHeaderLine(threads_oss.str());
+  relReporter->addHeaderLine(mutants_oss.str());
+  if (islands > 1)
+	relReporter->addHeaderLine(island_oss.str());
+
+  scheduler::Optimizer optimizer(archive, iterationReporter, max_iterations, verbose);
+  std::vector<std::string> intermediateHeader;
+  intermediateHeader.push_back("intermediate results");
+  intermediateHeader.push_back(resourceInfo);
+  intermediateHeader.push_back(oss1.str());
+  intermediateHeader.push_back(oss2.str());
+  std::ostringstream intermediate_oss;
+  intermediate_oss << islanddir << "/intermediate-";
+  optimizer.setMutantsPerGeneration(mutants);
+  optimizer.setIntermediateReports(intermediate_oss.str(), report_interval, intermediateHeader);
+  optimizer.setInterruptFlag(&interrupted);
+  if (checkpoint_interval > 0 || resume) {
+	optimizer.setCheckpoints(checkpointFile, checkpoint_interval, experiment);
+	if (checkpoint_interval > 0)
+	  std::cout << "Writing a checkpoint every " << checkpoint_interval << " iterations to " << checkpointFile << std::endl;
+  }
+  if (checkpoint) {
+	current=optimizer.resume(checkpoint);
+	std::cout << "RNG seed value restored to " << util::RNG::instance().get_seed() << std::endl;
+  }
+  scheduler::IslandExchange::Ptr exchange;
+  if (islands > 1) {
+	exchange=scheduler::IslandExchange::Ptr(new scheduler::IslandExchange(outputdir,
+		  island_id, islands, workload, resources));
+	optimizer.setIslandExchange(exchange, migration_interval);
+	std::cout << "Migrating schedules every " << migration_interval << " iterations." << std::endl;
+  }
 
   // mark start time.
-  long start_time = getCurrentMilliseconds();
+  long start_time = util::getCurrentMilliseconds();
   std::cout << "Start time is " << start_time << std::endl;
   
   // Main loop
-  double prev_distance=0.0;
-  double sum_delta_distance=0.0;
-  for( unsigned long iteration = 0; iteration < max_iterations; iteration += 1) {
-	// 2. mutate c to produce m and evaluate m
-	scheduler::Schedule::Ptr mutation(new scheduler::Schedule(*current));
-	mutation->mutate();
-	if(verbose) {
-	  std::cout << "# schedule: " << current->str() << std::endl;
-	  std::cout << "Total QT: "  << current->getTotalQueueTime() << ", price: " << current->getTotalPrice() << std::endl;
-	  std::cout << "# mutation: " << mutation->str() << std::endl;
-	  std::cout << "Total QT: "  << mutation->getTotalQueueTime() << ", price: " << mutation->getTotalPrice() << std::endl;
-	}
-	int compare=mutation->compare(current);
-	// First, compare the current solution to the mutation.
-	if (compare == scheduler::Schedule::IS_DOMINATED) {
-	  if (verbose)
-		std::cout << "(1) Current schedule dominates the mutation - discarding mutation." << std::endl;
-	  ;;
-	} else if (compare == scheduler::Schedule::DOMINATES) {
-	  if (verbose)
-		std::cout << "(2) Mutation dominates current schedule - replacing current + adding to archive." << std::endl;
-	  current = mutation;
-	  if (archive->archiveSchedule(mutation)) {
-		archive->updateAllLocations();
-		archivedSolutions++;
-	  }
-	} else if (compare == scheduler::Schedule::NO_DOMINATION) {
-	  if (verbose)
-		std::cout << "(3) No decideable domination - comparing mutation to archive." << std::endl;
-	  // if mutation is dominated by any member of the archive - discard it.
-	  if (archive->dominates(mutation)) {
-		if (verbose)
-		  std::cout << "(3a) Archive dominates mutation - discarding mutation." << std::endl;
-		;;
-	  } else {
-		// Unclear if we should add this solution.
-		if (verbose)
-		  std::cout << "(3b) Running test routine." << std::endl;
-		// archive solution
-		if (archive->archiveSchedule(mutation)) {
-		  archive->updateAllLocations();
-		  //archivedSolutions++; 
-		}
-		// if mutation dominates the archive or is in less crowded grid location than current
-		// replace current with mutation.
-		if (verbose)
-		  std::cout << "(3b) Current population: " << archive->getPopulationStr();
-		unsigned long current_population = archive->getPopulationCount(current->getLocation());
-		unsigned long mutation_population = archive->getPopulationCount(mutation->getLocation());
-		if (archive->isDominated(mutation) || mutation_population < current_population) {
-		  if (verbose)
-			std::cout << "(3b) Replacing current solution with mutation." << std::endl;
-		  current = mutation;
-		  //archivedSolutions++;
-		} 
-	  }
-	}
-	// Create reports.
-	if ((iteration % 1000) == 0) {
-	  // print some stats.
-	  double current_distance=archive->getDistance();
-	  double delta_distance = (fabs(current_distance - prev_distance)/current_distance);
-	  std::cout.precision(32);
-	  std::cout << "Iteration "<< iteration << ": dominant " << archivedSolutions;
-	  std::cout << "/1000, archive size " << archive->size() << ", distance: " << current_distance;
-	  std::cout << ", delta distance (%): " <<  delta_distance << std::endl;
-	  prev_distance=current_distance;
-	  sum_delta_distance+=delta_distance;
-
-	  std::ostringstream logLine;
-	  logLine << iteration << "\t" << archivedSolutions << "\t" << archive->size() << "\t" << archive->getDistance();
-	  iterationReporter->addReportLine(logLine.str());
-	  archivedSolutions=0;
-	}
-	if ((iteration % report_interval) == 0) {
-	  std::cout << "Generating intermediate reports." << std::endl;
-	  std::ostringstream filename_oss;
-	  filename_oss << outputdir << "/intermediate-" << iteration << ".txt";
-	  util::ReportWriter::Ptr absReporter(new util::ReportWriter(filename_oss.str()));
-	  std::string headerLine("intermediate results");
-	  absReporter->addHeaderLine(headerLine);
-	  std::string resourceInfo(resources->str());
-	  absReporter->addHeaderLine(resourceInfo);
-	  std::ostringstream oss1;
-	  oss1 << "Workload file: " << inputfile;
-	  absReporter->addHeaderLine(oss1.str());
-	  std::ostringstream oss2;
-	  oss2 << "Workload size: " << workload->size();
-	  absReporter->addHeaderLine(oss2.str());
-	  absReporter->addReportLine(archive->getAbsLogLines());
-	  absReporter->writeReport();
-	}
-
-	/**
-	 * Termination criterion: abort if the results do not change any more. This is the 
-	 * case if the delta distance is 0.0 for the last 10000 iterations,
-	 * we assume that there is no better solution.
-	 */
-	if ((iteration % 10000) == 0) {
-	  // Each 10 evaluation cycles
-	  if (sum_delta_distance == 0.0) {
-		std::cout << "No delta distance - we're stable. Exiting." << std::endl;
-		break;
-	  } else {
-		sum_delta_distance = 0.0;
-	  }
-	}
-  }
+  util::RNG& rng=util::RNG::instance();
+  optimizer.run(current, threads, rng.get_seed());
 
-  long end_time = getCurrentMilliseconds();
+  long end_time = util::getCurrentMilliseconds();
   std::cout << "Runtime was " << ((end_time - start_time) / 1000) << " seconds." << std::endl;
+  std::ostringstream throughput_oss;
+  throughput_oss << "Evaluations: " << optimizer.getIterations();
+  throughput_oss << ", evaluations/s: " << optimizer.getEvaluationsPerSecond();
+  throughput_oss << ", speedup (worker CPU time / wall time): " << optimizer.getSpeedup();
+  std::cout << throughput_oss.str() << std::endl;
+  iterationReporter->addHeaderLine(throughput_oss.str());
+  std::istringstream telemetry(util::telemetry::getSummary(util::telemetry::getTotals(),
+		(end_time - start_time) / 1000.0));
+  std::string telemetryLine;
+  while (std::getline(telemetry, telemetryLine)) {
+	std::cout << telemetryLine << std::endl;
+	iterationReporter->addHeaderLine(telemetryLine);
+  }
 
   // Finally, save the collected results.
   saveResults();
 
+  if (optimizer.isInterrupted()) {
+	std::cout << "Interrupted at iteration " << optimizer.getIterations() << "." << std::endl;
+	std::cout << "RNG seed value was " << util::RNG::instance().get_seed() << std::endl;
+	return -2;
+  }
+
+  // The last island to finish merges the fronts of all islands.
+  if (exchange) {
+	exchange->writeFinal(archive);
+	scheduler::ScheduleArchive::Ptr merged(new scheduler::ScheduleArchive(experiment->getArchiveSize(),
+		  workload->size(), experiment->getLocationBits()));
+	if (exchange->mergeFinal(merged)) {
+	  std::cout << "Merged the archives of " << islands << " islands, front size " << merged->size() << std::endl;
+	  std::ostringstream merged_oss;
+	  merged_oss << "Merged front of " << islands << " islands";
+	  util::ReportWriter::Ptr mergedAbsReporter(new util::ReportWriter(std::string(outputdir)+"/absolute-results.txt"));
+	  util::ReportWriter::Ptr mergedRelReporter(new util::ReportWriter(std::string(outputdir)+"/relative-results.txt"));
+	  mergedAbsReporter->addHeaderLine(headerLine + inputfile);
+	  mergedRelReporter->addHeaderLine(headerLine + inputfile);
+	  mergedAbsReporter->addHeaderLine(resourceInfo);
+	  mergedRelReporter->addHeaderLine(resourceInfo);
+	  mergedAbsReporter->addHeaderLine(oss1.str());
+	  mergedRelReporter->addHeaderLine(oss1.str());
+	  mergedAbsReporter->addHeaderLine(oss2.str());
+	  mergedRelReporter->addHeaderLine(oss2.str());
+	  mergedAbsReporter->addHeaderLine(oss3.str());
+	  mergedRelReporter->addHeaderLine(oss3.str());
+	  mergedAbsReporter->addHeaderLine(merged_oss.str());
+	  mergedRelReporter->addHeaderLine(merged_oss.str());
+	  mergedAbsReporter->addReportLine(merged->getAbsLogLines());
+	  mergedRelReporter->addReportLine(merged->getRelLogLines());
+	  mergedAbsReporter->writeReport();
+	  mergedRelReporter->writeReport();
+	}
+  }
+
   return 0;
 }
 
@@ -0,0 +1,38 @@
+#include "mappedfile.hpp"
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace util;
+
+MappedFile::MappedFile (const std::string& filename) :
+  _data(NULL), _size(0)
+{
+  int fd=open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+	throw std::runtime_error("Unable to open file " + filename);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+	close(fd);
+	throw std::runtime_error("Unable to stat file " + filename);
+  }
+  _size=st.st_size;
+  if (_size > 0) {
+	void* data=mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) {
+	  close(fd);
+	  throw std::runtime_error("Unable to map file " + filename);
+	}
+	_data=static_cast<char*>(data);
+	madvise(_data, _size, MADV_SEQUENTIAL);
+  }
+  // the mapping stays valid without the descriptor
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (_data != NULL)
+	munmap(_data, _size);
+}
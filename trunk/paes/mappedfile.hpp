@@ -0,0 +1,29 @@
+#ifndef PAES_MAPPEDFILE_HPP
+#define PAES_MAPPEDFILE_HPP 1
+
+#include <common.hpp>
+
+namespace util {
+  /**
+   * Maps a file read-only into memory. The mapping lives as long as the
+   * object. Throws std::runtime_error if the file cannot be opened or
+   * mapped.
+   */
+  class MappedFile {
+	public:
+	  typedef std::tr1::shared_ptr<MappedFile> Ptr;
+	  MappedFile (const std::string& filename);
+	  virtual ~MappedFile();
+	  const char* begin() const { return _data; };
+	  const char* end() const { return _data + _size; };
+	  size_t size() const { return _size; };
+
+	private:
+	  MappedFile (const MappedFile& original);
+	  MappedFile& operator= (const MappedFile& rhs);
+	  char* _data;
+	  size_t _size;
+  };
+}
+
+#endif /* PAES_MAPPEDFILE_HPP */
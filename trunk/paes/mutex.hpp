@@ -0,0 +1,73 @@
+#ifndef PAES_MUTEX_HPP
+#define PAES_MUTEX_HPP 1
+
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+namespace util {
+  /**
+   * Wraps a pthread mutex.
+   */
+  class Mutex {
+	public:
+	  Mutex () { pthread_mutex_init(&_mutex, NULL); };
+	  virtual ~Mutex() { pthread_mutex_destroy(&_mutex); };
+	  void lock() { pthread_mutex_lock(&_mutex); };
+	  void unlock() { pthread_mutex_unlock(&_mutex); };
+
+	private:
+	  friend class Condition;
+	  Mutex (const Mutex& original);
+	  Mutex& operator= (const Mutex& rhs);
+	  pthread_mutex_t _mutex;
+  };
+
+  /**
+   * Wraps a pthread condition variable. The wait functions must be
+   * called with the mutex held.
+   */
+  class Condition {
+	public:
+	  Condition () { pthread_cond_init(&_condition, NULL); };
+	  virtual ~Condition() { pthread_cond_destroy(&_condition); };
+	  void wait(Mutex& mutex) { pthread_cond_wait(&_condition, &mutex._mutex); };
+	  /**
+	   * Returns false if the time ran out before a signal came.
+	   */
+	  bool wait(Mutex& mutex, const long milliseconds) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += milliseconds / 1000;
+		deadline.tv_nsec += (milliseconds % 1000) * 1000000;
+		if (deadline.tv_nsec >= 1000000000) {
+		  deadline.tv_sec++;
+		  deadline.tv_nsec -= 1000000000;
+		}
+		return pthread_cond_timedwait(&_condition, &mutex._mutex, &deadline) != ETIMEDOUT;
+	  };
+	  void signal() { pthread_cond_signal(&_condition); };
+	  void broadcast() { pthread_cond_broadcast(&_condition); };
+
+	private:
+	  Condition (const Condition& original);
+	  Condition& operator= (const Condition& rhs);
+	  pthread_cond_t _condition;
+  };
+
+  /**
+   * Holds the mutex for the lifetime of the object.
+   */
+  class ScopedLock {
+	public:
+	  ScopedLock (Mutex& mutex) : _mutex(mutex) { _mutex.lock(); };
+	  virtual ~ScopedLock() { _mutex.unlock(); };
+
+	private:
+	  ScopedLock (const ScopedLock& original);
+	  ScopedLock& operator= (const ScopedLock& rhs);
+	  Mutex& _mutex;
+  };
+}
+
+#endif /* PAES_MUTEX_HPP */
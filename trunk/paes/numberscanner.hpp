@@ -0,0 +1,162 @@
+#ifndef PAES_NUMBERSCANNER_HPP
+#define PAES_NUMBERSCANNER_HPP 1
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+namespace util {
+  /**
+   * Scans whitespace separated numbers from a character range, e.g. a
+   * memory mapped file. The range does not need to be 0-terminated and
+   * nothing is copied. Each scan function skips leading blanks, reads
+   * one number that must end at a blank or at the end of the range and
+   * advances pos behind it. On failure it returns false and leaves pos
+   * unchanged.
+   */
+  namespace scanner {
+	inline bool isBlank(const char c) {
+	  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	inline const char* skipBlanks(const char* pos, const char* end) {
+	  while (pos < end && isBlank(*pos))
+		pos++;
+	  return pos;
+	}
+
+	inline bool isDigit(const char c) {
+	  return c >= '0' && c <= '9';
+	}
+
+	inline bool scanUnsigned(const char*& pos, const char* end, unsigned int& value) {
+	  const char* p=skipBlanks(pos, end);
+	  if (p == end || ! isDigit(*p))
+		return false;
+	  uint64_t result=0;
+	  while (p < end && isDigit(*p)) {
+		result = result * 10 + (*p - '0');
+		if (result > UINT_MAX)
+		  return false;
+		p++;
+	  }
+	  if (p < end && ! isBlank(*p))
+		return false;
+	  value=(unsigned int) result;
+	  pos=p;
+	  return true;
+	}
+
+	/**
+	 * Decimal numbers with up to 19 significant digits and a decimal
+	 * exponent of at most 22 are converted exactly with one
+	 * multiplication or division (Clinger's fast path), all others by
+	 * strtod(). Both round correctly, so the result is the same as
+	 * with strtod() or operator>>.
+	 */
+	inline bool scanDouble(const char*& pos, const char* end, double& value) {
+	  static const double POWERS_OF_TEN[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	  };
+	  const char* start=skipBlanks(pos, end);
+	  const char* p=start;
+	  bool negative=false;
+	  if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		p++;
+	  }
+	  uint64_t mantissa=0;
+	  int digits=0;
+	  int exponent=0;
+	  bool anyDigit=false;
+	  bool truncated=false;
+	  while (p < end && isDigit(*p)) {
+		anyDigit=true;
+		if (digits < 19) {
+		  mantissa = mantissa * 10 + (*p - '0');
+		  if (mantissa != 0)
+			digits++;
+		} else {
+		  exponent++;
+		  truncated=true;
+		}
+		p++;
+	  }
+	  if (p < end && *p == '.') {
+		p++;
+		while (p < end && isDigit(*p)) {
+		  anyDigit=true;
+		  if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa != 0)
+			  digits++;
+			exponent--;
+		  } else {
+			truncated=true;
+		  }
+		  p++;
+		}
+	  }
+	  if (! anyDigit)
+		return false;
+	  if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool negativeExponent=false;
+		if (p < end && (*p == '-' || *p == '+')) {
+		  negativeExponent = (*p == '-');
+		  p++;
+		}
+		if (p == end || ! isDigit(*p))
+		  return false;
+		int e=0;
+		while (p < end && isDigit(*p)) {
+		  if (e < 100000)
+			e = e * 10 + (*p - '0');
+		  p++;
+		}
+		exponent += negativeExponent ? -e : e;
+	  }
+	  if (p < end && ! isBlank(*p))
+		return false;
+	  if (! truncated && mantissa <= (((uint64_t) 1) << 53) &&
+		  exponent >= -22 && exponent <= 22) {
+		double result=(double) mantissa;
+		if (exponent < 0)
+		  result /= POWERS_OF_TEN[-exponent];
+		else
+		  result *= POWERS_OF_TEN[exponent];
+		value = negative ? -result : result;
+	  } else {
+		char buffer[128];
+		size_t length=p - start;
+		if (length >= sizeof(buffer))
+		  return false;
+		memcpy(buffer, start, length);
+		buffer[length]='\0';
+		value=strtod(buffer, NULL);
+	  }
+	  pos=p;
+	  return true;
+	}
+
+	/**
+	 * An unsigned number that may also be written as a decimal, e.g.
+	 * 4.0 or 4e0, as long as its value is a whole number in range.
+	 */
+	inline bool scanIntegral(const char*& pos, const char* end, unsigned int& value) {
+	  const char* p=pos;
+	  double result;
+	  if (! scanDouble(p, end, result) || result < 0.0 || result > UINT_MAX ||
+		  result != floor(result))
+		return false;
+	  value=(unsigned int) result;
+	  pos=p;
+	  return true;
+	}
+  }
+}
+
+#endif /* PAES_NUMBERSCANNER_HPP */
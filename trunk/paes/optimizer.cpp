@@ -0,0 +1,405 @@
+#include "optimizer.hpp"
+#include <sstream>
+#include <math.h>
+#include <pthread.h>
+#include <clock.hpp>
+#include <random.hpp>
+#include <mutex.hpp>
+#include <telemetry.hpp>
+
+using namespace scheduler;
+
+Optimizer::Optimizer (const scheduler::ScheduleArchive::Ptr& archive,
+	const util::ReportWriter::Ptr& iterationReporter,
+	const unsigned long maxIterations, const bool verbose) :
+  _archive(archive),
+  _iterationReporter(iterationReporter),
+  _maxIterations(maxIterations),
+  _verbose(verbose),
+  _reportPrefix(),
+  _reportInterval(0),
+  _reportHeader(),
+  _exchange(),
+  _migrationInterval(0),
+  _mutantsPerGeneration(1),
+  _checkpointFile(),
+  _checkpointInterval(0),
+  _experiment(),
+  _interrupted(NULL),
+  _iteration(0),
+  _stop(false),
+  _activeWorkers(0),
+  _startIteration(0),
+  _archivedSolutions(0),
+  _prevDistance(0.0),
+  _lastDistance(0.0),
+  _lastChangeIteration(0),
+  _lastReportTime(0),
+  _lastReportIteration(0),
+  _workerTime(0.0),
+  _wallTime(0),
+  _lastTelemetry()
+{ }
+
+void Optimizer::setIntermediateReports(const std::string& prefix, const unsigned long interval,
+	const std::vector<std::string>& headerLines) {
+  _reportPrefix=prefix;
+  _reportInterval=interval;
+  _reportHeader=headerLines;
+}
+
+void Optimizer::setIslandExchange(const scheduler::IslandExchange::Ptr& exchange,
+	const unsigned long interval) {
+  _exchange=exchange;
+  _migrationInterval=interval;
+}
+
+void Optimizer::setMutantsPerGeneration(const unsigned int lambda) {
+  _mutantsPerGeneration = lambda > 0 ? lambda : 1;
+}
+
+void Optimizer::setCheckpoints(const std::string& filename, const unsigned long interval,
+	const config::ExperimentConfig::Ptr& experiment) {
+  _checkpointFile=filename;
+  _checkpointInterval=interval;
+  _experiment=experiment;
+}
+
+scheduler::Schedule::Ptr Optimizer::resume(const scheduler::Checkpoint::Ptr& checkpoint) {
+  const Checkpoint::LoopState& state=checkpoint->getLoopState();
+  _iteration=state.iteration;
+  _archivedSolutions=state.archivedSolutions;
+  _lastReportIteration=state.lastReportIteration;
+  _prevDistance=state.prevDistance;
+  _lastDistance=state.lastDistance;
+  _lastChangeIteration=state.lastChangeIteration;
+  _stop=state.stop;
+  _archive->restore(checkpoint->getArchive(), checkpoint->getGrid());
+  util::RNG& rng=util::RNG::instance();
+  rng.set_seed(checkpoint->getSeed());
+  rng.getEngine().setState(checkpoint->getRNGState());
+  return checkpoint->getCurrent();
+}
+
+void Optimizer::run(const scheduler::Schedule::Ptr& initial, const unsigned int threads,
+	const unsigned int seed) {
+  long start_time = util::getCurrentMilliseconds();
+  _lastReportTime = start_time;
+  _activeWorkers = threads > 1 ? threads : 1;
+  _startIteration = getIterations();
+  _lastTelemetry = util::telemetry::getTotals();
+  if (threads <= 1) {
+	double cpu_start = util::getThreadCPUSeconds();
+	workerLoop(initial);
+	_workerTime += util::getThreadCPUSeconds() - cpu_start;
+  } else {
+	std::vector<pthread_t> workers(threads);
+	std::vector<WorkerArgs> args(threads);
+	for (unsigned int i = 0; i < threads; i++) {
+	  args[i].optimizer=this;
+	  args[i].initial=initial;
+	  args[i].seed=seed;
+	  args[i].stream=i + 1;
+	  if (pthread_create(&workers[i], NULL, Optimizer::workerMain, &args[i]) != 0) {
+		std::cerr << "Unable to start worker thread, aborting" << std::endl;
+		exit(-1);
+	  }
+	}
+	for (unsigned int i = 0; i < threads; i++) {
+	  pthread_join(workers[i], NULL);
+	}
+  }
+  _wallTime = util::getCurrentMilliseconds() - start_time;
+}
+
+void* Optimizer::workerMain(void* args) {
+  WorkerArgs* workerArgs=static_cast<WorkerArgs*>(args);
+  util::RNG::attachThreadInstance(workerArgs->seed, workerArgs->stream);
+  double cpu_start = util::getThreadCPUSeconds();
+  workerArgs->optimizer->workerLoop(workerArgs->initial);
+  double cpu_time = util::getThreadCPUSeconds() - cpu_start;
+  util::ScopedLock lock(workerArgs->optimizer->_archive->getMutex());
+  workerArgs->optimizer->_workerTime += cpu_time;
+  return NULL;
+}
+
+void Optimizer::workerLoop(scheduler::Schedule::Ptr current) {
+  std::vector<scheduler::Schedule::Ptr> mutants;
+  mutants.reserve(_mutantsPerGeneration);
+  while (! _stop && ! isInterrupted()) {
+	unsigned long first = __sync_fetch_and_add(&_iteration, _mutantsPerGeneration);
+	if (first >= _maxIterations)
+	  break;
+	unsigned long last = first + _mutantsPerGeneration;
+	if (last > _maxIterations)
+	  last = _maxIterations;
+	step(current, mutants, first, last - first);
+	for (unsigned long iteration = first; iteration < last; iteration++) {
+	  if (isReportIteration(iteration)) {
+		std::vector<scheduler::Schedule::Ptr> front;
+		{
+		  util::ScopedLock lock(_archive->getMutex());
+		  report(iteration);
+		  if (isMigrationIteration(iteration))
+			front=_archive->getSortedSchedules();
+		}
+		if (isMigrationIteration(iteration))
+		  migrate(iteration, front);
+	  }
+	}
+	/**
+	 * Termination criterion: abort if the results do not change any
+	 * more. This is the case if the distance did not change for the
+	 * last CONVERGENCE_ITERATIONS iterations, we assume that there is
+	 * no better solution.
+	 */
+	unsigned long lastChange = __atomic_load_n(&_lastChangeIteration, __ATOMIC_RELAXED);
+	if (last - 1 >= lastChange + CONVERGENCE_ITERATIONS) {
+	  util::ScopedLock lock(_archive->getMutex());
+	  if (! _stop) {
+		std::cout << "No delta distance since iteration " << lastChange << " - we're stable. Exiting." << std::endl;
+		_stop=true;
+	  }
+	}
+	if (_checkpointInterval > 0 && first / _checkpointInterval != last / _checkpointInterval) {
+	  util::ScopedLock lock(_archive->getMutex());
+	  writeCheckpoint(current);
+	}
+  }
+  // The last worker to leave saves the final state.
+  util::ScopedLock lock(_archive->getMutex());
+  if (--_activeWorkers == 0 && ! _checkpointFile.empty())
+	writeCheckpoint(current);
+}
+
+/**
+ * Must be called with the archive lock held, between two generations
+ * of the calling worker.
+ */
+void Optimizer::writeCheckpoint(const scheduler::Schedule::Ptr& current) {
+  Checkpoint checkpoint(current->getWorkload(), current->getResources(), _experiment);
+  Checkpoint::LoopState state;
+  // the other workers may be claiming iterations concurrently
+  unsigned long claimed = __sync_fetch_and_add(&_iteration, 0);
+  state.iteration = claimed < _maxIterations ? claimed : _maxIterations;
+  state.archivedSolutions=_archivedSolutions;
+  state.lastReportIteration=_lastReportIteration;
+  state.prevDistance=_prevDistance;
+  state.lastDistance=_lastDistance;
+  state.lastChangeIteration=_lastChangeIteration;
+  state.stop=_stop;
+  checkpoint.setLoopState(state);
+  util::RNG& rng=util::RNG::instance();
+  checkpoint.setRNG(rng.get_seed(), rng.getEngine().getState());
+  checkpoint.setArchive(_archive->getSortedSchedules());
+  checkpoint.setGrid(_archive->getGridLayout());
+  checkpoint.setCurrent(current);
+  // the recorded size must be on disk before the checkpoint is
+  if (! _iterationReporter->sync()) {
+	std::cerr << "Unable to write the runtime report - no checkpoint written." << std::endl;
+	return;
+  }
+  checkpoint.setReportSize(_iterationReporter->getSize());
+  try {
+	checkpoint.write(_checkpointFile);
+	if (_verbose)
+	  std::cout << "Checkpoint at iteration " << state.iteration << " written to " << _checkpointFile << std::endl;
+  } catch (const std::runtime_error& e) {
+	std::cerr << e.what() << " - no checkpoint written." << std::endl;
+  }
+}
+
+bool Optimizer::isReportIteration(const unsigned long iteration) {
+  return (iteration % 1000) == 0 ||
+	(_reportInterval > 0 && (iteration % _reportInterval) == 0) ||
+	isMigrationIteration(iteration);
+}
+
+bool Optimizer::isMigrationIteration(const unsigned long iteration) {
+  return _exchange && _migrationInterval > 0 && iteration > 0 &&
+	(iteration % _migrationInterval) == 0;
+}
+
+/**
+ * Exchanges schedules with the other islands. The files are written and
+ * read and the immigrants evaluated without the archive lock, the
+ * other workers keep running meanwhile. Emigrants come from the front
+ * the caller took with the lock held.
+ */
+void Optimizer::migrate(const unsigned long iteration,
+	const std::vector<scheduler::Schedule::Ptr>& front) {
+  _exchange->emigrate(front);
+  std::vector<scheduler::Schedule::Ptr> immigrants=_exchange->immigrate();
+  util::ScopedLock lock(_archive->getMutex());
+  std::vector<scheduler::Schedule::Ptr>::iterator it;
+  for(  it = immigrants.begin(); it < immigrants.end(); it++) {
+	_archive->archiveSchedule(*it);
+  }
+  if (immigrants.size() > 0)
+	std::cout << "Island " << _exchange->getIslandID() << ": received " << immigrants.size() << " schedules." << std::endl;
+  noteChanges(iteration);
+}
+
+/**
+ * One PAES generation: create and evaluate count mutants of the current
+ * schedule without holding the archive lock, then decide for each one
+ * whether it replaces the current schedule and/or enters the archive.
+ */
+void Optimizer::step(scheduler::Schedule::Ptr& current, std::vector<scheduler::Schedule::Ptr>& mutants,
+	const unsigned long first, const unsigned int count) {
+  // 2. mutate c to produce m and evaluate m. The mutants share all
+  // queues but the two modified ones with c.
+  mutants.clear();
+  for (unsigned int i = 0; i < count; i++) {
+	scheduler::Schedule::Ptr mutation;
+	{
+	  TELEMETRY_TIMER(MUTATE);
+	  mutation=scheduler::Schedule::Ptr(new scheduler::Schedule(*current));
+	  mutation->mutate();
+	}
+	mutation->update();
+	mutants.push_back(mutation);
+  }
+  if (count == 1 && mutants[0]->compare(current) == scheduler::Schedule::IS_DOMINATED) {
+	// case (1) does not touch the archive, no need to lock it.
+	accept(current, mutants[0]);
+	return;
+  }
+  util::ScopedLock lock(_archive->getMutex());
+  _archive->beginBatch();
+  std::vector<scheduler::Schedule::Ptr>::iterator it;
+  for(  it = mutants.begin(); it != mutants.end(); it++) {
+	accept(current, *it);
+  }
+  _archive->endBatch();
+  noteChanges(first + count - 1);
+}
+
+/**
+ * Remembers the iteration if the distance of the archive changed.
+ * Must be called with the archive lock held.
+ */
+void Optimizer::noteChanges(const unsigned long iteration) {
+  double distance=_archive->getDistance();
+  if (distance != _lastDistance) {
+	_lastDistance=distance;
+	__atomic_store_n(&_lastChangeIteration, iteration, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * The PAES acceptance test of one mutation. Must be called with the
+ * archive lock held, unless the current schedule dominates the
+ * mutation.
+ */
+void Optimizer::accept(scheduler::Schedule::Ptr& current, const scheduler::Schedule::Ptr& mutation) {
+  if(_verbose) {
+	std::cout << "# schedule: " << current->str() << std::endl;
+	std::cout << "Total QT: "  << current->getTotalQueueTime() << ", price: " << current->getTotalPrice() << std::endl;
+	std::cout << "# mutation: " << mutation->str() << std::endl;
+	std::cout << "Total QT: "  << mutation->getTotalQueueTime() << ", price: " << mutation->getTotalPrice() << std::endl;
+  }
+  int compare=mutation->compare(current);
+  // First, compare the current solution to the mutation.
+  if (compare == scheduler::Schedule::IS_DOMINATED) {
+	TELEMETRY_COUNT(BRANCH_1);
+	if (_verbose)
+	  std::cout << "(1) Current schedule dominates the mutation - discarding mutation." << std::endl;
+	return;
+  }
+  if (compare == scheduler::Schedule::DOMINATES) {
+	TELEMETRY_COUNT(BRANCH_2);
+	if (_verbose)
+	  std::cout << "(2) Mutation dominates current schedule - replacing current + adding to archive." << std::endl;
+	current = mutation;
+	if (_archive->archiveSchedule(mutation))
+	  _archivedSolutions++;
+  } else if (compare == scheduler::Schedule::NO_DOMINATION) {
+	if (_verbose)
+	  std::cout << "(3) No decideable domination - comparing mutation to archive." << std::endl;
+	// if mutation is dominated by any member of the archive - discard it.
+	if (_archive->dominates(mutation)) {
+	  TELEMETRY_COUNT(BRANCH_3A);
+	  if (_verbose)
+		std::cout << "(3a) Archive dominates mutation - discarding mutation." << std::endl;
+	  ;;
+	} else {
+	  // Unclear if we should add this solution.
+	  TELEMETRY_COUNT(BRANCH_3B);
+	  if (_verbose)
+		std::cout << "(3b) Running test routine." << std::endl;
+	  // archive solution
+	  _archive->archiveSchedule(mutation);
+	  // if mutation dominates the archive or is in less crowded grid location than current
+	  // replace current with mutation.
+	  if (_verbose)
+		std::cout << "(3b) Current population: " << _archive->getPopulationStr();
+	  if (_archive->isDominated(mutation) ||
+		  _archive->getPopulationCount(mutation) <
+		  _archive->getPopulationCount(current)) {
+		if (_verbose)
+		  std::cout << "(3b) Replacing current solution with mutation." << std::endl;
+		current = mutation;
+		//archivedSolutions++;
+	  }
+	}
+  }
+}
+
+/**
+ * Statistics, intermediate reports and the termination criterion.
+ * Must be called with the archive lock held.
+ */
+void Optimizer::report(const unsigned long iteration) {
+  TELEMETRY_TIMER(REPORT);
+  // Create reports.
+  if ((iteration % 1000) == 0) {
+	// print some stats.
+	double current_distance=_archive->getDistance();
+	double delta_distance = (fabs(current_distance - _prevDistance)/current_distance);
+	long now = util::getCurrentMilliseconds();
+	double evaluations_per_second = 0.0;
+	if (now > _lastReportTime)
+	  evaluations_per_second = (iteration - _lastReportIteration) * 1000.0 / (now - _lastReportTime);
+	std::cout.precision(32);
+	std::cout << "Iteration "<< iteration << ": dominant " << _archivedSolutions;
+	std::cout << "/1000, archive size " << _archive->size() << ", distance: " << current_distance;
+	std::cout << ", delta distance (%): " <<  delta_distance << std::endl;
+	_prevDistance=current_distance;
+
+	std::ostringstream logLine;
+	logLine << iteration << "\t" << _archivedSolutions << "\t" << _archive->size() << "\t" << current_distance;
+	logLine << "\t" << evaluations_per_second;
+	util::telemetry::Values telemetry=util::telemetry::getTotals();
+	logLine << util::telemetry::getColumns(telemetry, _lastTelemetry);
+	_lastTelemetry=telemetry;
+	_iterationReporter->addReportLine(logLine.str());
+	_archivedSolutions=0;
+	_lastReportTime=now;
+	_lastReportIteration=iteration;
+  }
+  if (_reportInterval > 0 && (iteration % _reportInterval) == 0) {
+	std::cout << "Generating intermediate reports." << std::endl;
+	std::ostringstream filename_oss;
+	filename_oss << _reportPrefix << iteration << ".txt";
+	util::ReportWriter::Ptr absReporter(new util::ReportWriter(filename_oss.str()));
+	std::vector<std::string>::iterator it;
+	for(it = _reportHeader.begin(); it < _reportHeader.end(); it++) {
+	  absReporter->addHeaderLine(*it);
+	}
+	// written by the report thread, the file is closed with the writer
+	absReporter->addReportLine(_archive->getAbsLogLines());
+  }
+}
+
+double Optimizer::getSpeedup() {
+  if (_wallTime <= 0)
+	return 0.0;
+  return _workerTime / (_wallTime / 1000.0);
+}
+
+double Optimizer::getEvaluationsPerSecond() {
+  if (_wallTime <= 0)
+	return 0.0;
+  return (getIterations() - _startIteration) / (_wallTime / 1000.0);
+}
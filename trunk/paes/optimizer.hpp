@@ -0,0 +1,144 @@
+#ifndef PAES_OPTIMIZER_HPP
+#define PAES_OPTIMIZER_HPP 1
+
+#include <common.hpp>
+#include <schedule.hpp>
+#include <schedulearchive.hpp>
+#include <reportwriter.hpp>
+#include <islandexchange.hpp>
+#include <checkpoint.hpp>
+#include <telemetry.hpp>
+#include <vector>
+#include <signal.h>
+
+namespace scheduler {
+  /**
+   * Runs the (1+1)-PAES main loop. Several workers can run the loop
+   * concurrently, each one mutating and evaluating its own current
+   * schedule. They share the archive, the iteration budget and the
+   * termination criterion.
+   */
+  class Optimizer {
+	public:
+	  typedef std::tr1::shared_ptr<Optimizer> Ptr;
+	  /**
+	   * The run ends once the distance of the archive did not change for
+	   * this many iterations. It is checked after every generation.
+	   */
+	  static const unsigned long CONVERGENCE_ITERATIONS = 10000;
+	  Optimizer (const scheduler::ScheduleArchive::Ptr& archive,
+		  const util::ReportWriter::Ptr& iterationReporter,
+		  const unsigned long maxIterations, const bool verbose);
+	  virtual ~Optimizer() {};
+	  /**
+	   * Dumps the archive to <prefix><iteration>.txt every interval
+	   * iterations, with the given header lines.
+	   */
+	  void setIntermediateReports(const std::string& prefix, const unsigned long interval,
+		  const std::vector<std::string>& headerLines);
+	  /**
+	   * Exchanges schedules with other islands every interval iterations.
+	   */
+	  void setIslandExchange(const scheduler::IslandExchange::Ptr& exchange,
+		  const unsigned long interval);
+	  /**
+	   * (1+lambda) mode: every generation creates lambda mutants of the
+	   * current schedule, evaluates them in one pass and passes them to
+	   * the archive as one batch. Each mutant counts as one iteration.
+	   */
+	  void setMutantsPerGeneration(const unsigned int lambda);
+	  /**
+	   * Writes a checkpoint to the file whenever the iteration counter
+	   * passes a multiple of interval, and when the main loop ends.
+	   * Writing a checkpoint does not change the search, and a resumed
+	   * run continues exactly like the checkpointed one. Only the state
+	   * of one worker is saved, so checkpoints need a single worker
+	   * thread and island. The checkpoint records the experiment, a
+	   * resume with a different one is rejected.
+	   */
+	  void setCheckpoints(const std::string& filename, const unsigned long interval,
+		  const config::ExperimentConfig::Ptr& experiment);
+	  /**
+	   * The main loop ends at the next generation once the flag is set,
+	   * e.g. by a signal handler.
+	   */
+	  void setInterruptFlag(const volatile sig_atomic_t* interrupted) { _interrupted=interrupted; };
+	  /**
+	   * Restores the archive, the loop counters and the random number
+	   * generator of the calling thread. The runtime report must have
+	   * been opened at the size stored in the checkpoint. Returns the
+	   * current schedule to pass to run().
+	   */
+	  scheduler::Schedule::Ptr resume(const scheduler::Checkpoint::Ptr& checkpoint);
+	  bool isInterrupted() const { return _interrupted != NULL && *_interrupted; };
+	  /**
+	   * Runs the main loop on the given number of threads, all workers
+	   * start from the initial schedule. With one thread, the loop runs
+	   * in the calling thread. Worker n gets its own random number
+	   * generator, stream n + 1 of the seed, so runs are reproducible
+	   * for a given seed and thread count.
+	   */
+	  void run(const scheduler::Schedule::Ptr& initial, const unsigned int threads,
+		  const unsigned int seed);
+	  unsigned long getIterations() { return _iteration < _maxIterations ? _iteration : _maxIterations; };
+	  /**
+	   * Returns the CPU time spent in the workers divided by the
+	   * wall-clock time of the last run.
+	   */
+	  double getSpeedup();
+	  double getEvaluationsPerSecond();
+
+	private:
+	  struct WorkerArgs {
+		Optimizer* optimizer;
+		scheduler::Schedule::Ptr initial;
+		unsigned int seed;
+		unsigned int stream;
+	  };
+	  static void* workerMain(void* args);
+	  void workerLoop(scheduler::Schedule::Ptr current);
+	  void step(scheduler::Schedule::Ptr& current, std::vector<scheduler::Schedule::Ptr>& mutants,
+		  const unsigned long first, const unsigned int count);
+	  void noteChanges(const unsigned long iteration);
+	  void accept(scheduler::Schedule::Ptr& current, const scheduler::Schedule::Ptr& mutation);
+	  bool isReportIteration(const unsigned long iteration);
+	  bool isMigrationIteration(const unsigned long iteration);
+	  void migrate(const unsigned long iteration,
+		  const std::vector<scheduler::Schedule::Ptr>& front);
+	  void report(const unsigned long iteration);
+	  void writeCheckpoint(const scheduler::Schedule::Ptr& current);
+	  Optimizer (const Optimizer& original);
+	  Optimizer& operator= (const Optimizer& rhs);
+	  scheduler::ScheduleArchive::Ptr _archive;
+	  util::ReportWriter::Ptr _iterationReporter;
+	  unsigned long _maxIterations;
+	  bool _verbose;
+	  std::string _reportPrefix;
+	  unsigned long _reportInterval;
+	  std::vector<std::string> _reportHeader;
+	  scheduler::IslandExchange::Ptr _exchange;
+	  unsigned long _migrationInterval;
+	  unsigned int _mutantsPerGeneration;
+	  std::string _checkpointFile;
+	  unsigned long _checkpointInterval;
+	  config::ExperimentConfig::Ptr _experiment;
+	  const volatile sig_atomic_t* _interrupted;
+	  // Shared loop state, the iteration counter is updated atomically,
+	  // everything else is protected by the archive mutex.
+	  volatile unsigned long _iteration;
+	  volatile bool _stop;
+	  unsigned int _activeWorkers;
+	  unsigned long _startIteration;
+	  unsigned long _archivedSolutions;
+	  double _prevDistance;
+	  double _lastDistance;
+	  unsigned long _lastChangeIteration;
+	  long _lastReportTime;
+	  unsigned long _lastReportIteration;
+	  double _workerTime;
+	  long _wallTime;
+	  util::telemetry::Values _lastTelemetry;
+  };
+}
+
+#endif /* PAES_OPTIMIZER_HPP */
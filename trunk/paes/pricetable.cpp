@@ -0,0 +1,47 @@
+#include "pricetable.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <math.h>
+
+using namespace scheduler;
+
+// 2^20, about a millionth of a currency unit
+const double PriceTable::PRICE_SCALE = 1048576.0;
+
+namespace {
+  // keeps the scaled price well inside int64_t
+  const double MAX_PRICE = 8.0e12;
+
+  PriceTable::PriceType toFixed(const double price, const Workload::IndexType& jobIndex,
+	  const Resource::IDType& resourceID) {
+	if (! (fabs(price) < MAX_PRICE)) {
+	  std::ostringstream oss;
+	  oss << "Price " << price << " of job index " << jobIndex << " on resource ";
+	  oss << resourceID << " is out of range";
+	  throw std::invalid_argument(oss.str());
+	}
+	return llround(price * PriceTable::PRICE_SCALE);
+  }
+}
+
+PriceTable::PriceTable (const scheduler::Workload::Ptr& workload,
+	const std::vector<scheduler::Resource::Ptr>& resources) :
+  _workload(workload),
+  _resources(resources),
+  _columns(resources.size()),
+  _prices()
+{
+  if (resources.empty() || workload->size() > MAX_ENTRIES / _columns)
+	return;
+  _prices.resize(workload->size() * _columns, 0);
+  for (Workload::IndexType job = 0; job < workload->size(); job++) {
+	for (size_t column = 0; column < _columns; column++)
+	  _prices[job * _columns + column]=computePrice(job, column);
+  }
+}
+
+PriceTable::PriceType PriceTable::computePrice(const scheduler::Workload::IndexType& jobIndex,
+	const size_t& column) const {
+  return toFixed(_resources[column]->getPrice(*_workload, jobIndex),
+	  jobIndex, _resources[column]->getResourceID());
+}
@@ -0,0 +1,61 @@
+#ifndef PAES_PRICETABLE_HPP
+#define PAES_PRICETABLE_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <resource.hpp>
+#include <vector>
+#include <stdint.h>
+
+namespace scheduler {
+  /**
+   * The price of every job on every resource. A job's price on a
+   * resource does not depend on the rest of the schedule, so the
+   * pricing plans are asked once when the table is built.
+   *
+   * Prices are stored in fixed point, in units of 1/PRICE_SCALE, one
+   * row per job and one column per resource, in the order of the given
+   * list, i.e. by ResourcePool index. Sums of fixed point
+   * prices are exact, so a schedule can keep its total price as a
+   * running sum and still gets the same bits as a fresh evaluation,
+   * whatever sequence of mutations led to it.
+   *
+   * Workloads with more than MAX_ENTRIES job/resource pairs are not
+   * tabulated, their prices are computed by the pricing plans on every
+   * lookup.
+   */
+  class PriceTable {
+	public:
+	  typedef std::tr1::shared_ptr<PriceTable> Ptr;
+	  typedef int64_t PriceType;
+	  typedef __int128 SumType;
+	  static const double PRICE_SCALE;
+	  static const size_t MAX_ENTRIES = 64 * 1024 * 1024;
+	  /**
+	   * Throws std::invalid_argument if a price is out of the fixed
+	   * point range.
+	   */
+	  PriceTable (const scheduler::Workload::Ptr& workload,
+		  const std::vector<scheduler::Resource::Ptr>& resources);
+	  virtual ~PriceTable() {};
+	  PriceType getPrice(const scheduler::Workload::IndexType& jobIndex,
+		  const size_t& column) const {
+		if (_prices.empty())
+		  return computePrice(jobIndex, column);
+		return _prices[jobIndex * _columns + column];
+	  };
+	  static double toDouble(const SumType& sum) { return sum / PRICE_SCALE; };
+
+	private:
+	  PriceTable (const PriceTable& original);
+	  PriceTable& operator= (const PriceTable& rhs);
+	  PriceType computePrice(const scheduler::Workload::IndexType& jobIndex,
+		  const size_t& column) const;
+	  scheduler::Workload::Ptr _workload;
+	  std::vector<scheduler::Resource::Ptr> _resources;
+	  size_t _columns;
+	  std::vector<PriceType> _prices;
+  };
+}
+
+#endif /* PAES_PRICETABLE_HPP */
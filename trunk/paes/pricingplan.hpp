@@ -2,7 +2,7 @@
 #define PRICINGPLAN_HPP 1
 
 #include <common.hpp>
-#include <job.hpp>
+#include <workload.hpp>
 
 
 namespace scheduler {
@@ -12,7 +12,8 @@ namespace scheduler {
 	  PricingPlan () {};
 	  virtual ~PricingPlan() {};
 
-	  virtual double getPrice(scheduler::Job::Ptr job) = 0;
+	  virtual double getPrice(const scheduler::Workload& workload,
+		  const scheduler::Workload::IndexType& jobIndex) const = 0;
 	  virtual const std::string str() = 0;
 	  
 	private:
@@ -1,27 +1,72 @@
 #include "random.hpp"
-#include <cstdlib>
 #include <ctime>
 #include <limits.h>
 #include <iostream>
+#include <pthread.h>
 
 
 using namespace util;
 
+namespace {
+  pthread_key_t threadInstanceKey;
+  pthread_once_t threadInstanceKeyOnce = PTHREAD_ONCE_INIT;
+
+  void deleteThreadInstance(void* instance) {
+	delete static_cast<RNG*>(instance);
+  }
+
+  void createThreadInstanceKey() {
+	pthread_key_create(&threadInstanceKey, deleteThreadInstance);
+  }
+}
+
 RNG& RNG::instance() {
+  pthread_once(&threadInstanceKeyOnce, createThreadInstanceKey);
+  RNG* threadInstance=static_cast<RNG*>(pthread_getspecific(threadInstanceKey));
+  if (threadInstance != NULL)
+	return *threadInstance;
   static RNG instance;
   return instance;
 }
 
-double RNG::uniform_deviate ( int seed ) {
-  return seed * ( 1.0 / ( RAND_MAX + 1.0 ) );
+void RNG::attachThreadInstance(unsigned int seed, unsigned int stream) {
+  pthread_once(&threadInstanceKeyOnce, createThreadInstanceKey);
+  RNG* previous=static_cast<RNG*>(pthread_getspecific(threadInstanceKey));
+  delete previous;
+  pthread_setspecific(threadInstanceKey, new RNG(seed, stream));
+}
+
+RNG::RNG(unsigned int seed, unsigned int stream) : _seed(seed), _engine(seed) {
+  for (unsigned int i = 0; i < stream; i++)
+	_engine.jump();
 }
 
-unsigned int RNG::uniform_derivate_int() {
-  return (unsigned int) uniform_deviate ( rand() ) * 10;
+double RNG::uniform_deviate () {
+  // the upper 53 bits fill the mantissa
+  return (_engine.next() >> 11) * (1.0 / 9007199254740992.0);
 }
 
+/**
+ * Lemire's multiply-and-shift method, see "Fast Random Integer
+ * Generation in an Interval", ACM TOMACS 2019. The rejection step
+ * removes the bias and is rarely taken.
+ */
 unsigned int RNG::uniform_derivate_ranged_int(unsigned int min, unsigned int max) {
-  return (unsigned int) (min + uniform_deviate ( rand() ) * ((max+1) - min));
+  uint32_t x = (uint32_t) (_engine.next() >> 32);
+  uint32_t range = max - min + 1;
+  if (range == 0) // [0, UINT_MAX]
+	return x;
+  uint64_t m = (uint64_t) x * range;
+  uint32_t l = (uint32_t) m;
+  if (l < range) {
+	uint32_t t = (-range) % range;
+	while (l < t) {
+	  x = (uint32_t) (_engine.next() >> 32);
+	  m = (uint64_t) x * range;
+	  l = (uint32_t) m;
+	}
+  }
+  return min + (unsigned int) (m >> 32);
 }
 
 void RNG::time_seed() {
@@ -43,5 +88,5 @@ unsigned int RNG::get_seed() {
 void RNG::set_seed(unsigned int seed) {
   //std::cout << "RNG: setting seed value to " << seed << std::endl;
   _seed=seed;
-  srand(_seed);
+  _engine.setSeed(_seed);
 }
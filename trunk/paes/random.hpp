@@ -1,32 +1,50 @@
 #ifndef PAES_RANDOM_HPP
 #define PAES_RANDOM_HPP 1
 
+#include <xoshiro.hpp>
+
 namespace util {
   /**
    * Wraps random functions.
-   * see http://eternallyconfuzzled.com/arts/jsw_art_rand.aspx
+   *
+   * instance() returns the generator of the calling thread. Threads
+   * without a generator of their own share the global one, so only the
+   * main thread should use it. All generators derive from the seed:
+   * stream n is the generator jumped n times, stream 0 is the global
+   * generator. The engine can be exchanged by changing EngineType.
    */
   class RNG {
 	public:
+	  typedef util::Xoshiro256 EngineType;
 	  static RNG& instance();
+	  /**
+	   * Gives the calling thread its own generator for the given stream
+	   * of the seed. The generator is freed when the thread exits.
+	   */
+	  static void attachThreadInstance(unsigned int seed, unsigned int stream);
 
-	  double uniform_deviate ( int seed );
-	  unsigned int uniform_derivate_int();
+	  /**
+	   * returns rand in [0, 1)
+	   */
+	  double uniform_deviate();
       void set_seed(unsigned int seed);
       unsigned int get_seed();
 	  /**
 	   * min: smallest allowed value, max: biggest allowed value (inclusive)
-	   * returns rand in [min, max]
+	   * returns rand in [min, max], all values have the same probability.
 	   */
 	  unsigned int uniform_derivate_ranged_int(unsigned int min, unsigned int max);
+	  EngineType& getEngine() { return _engine; };
 	  ~RNG(){};
 
 	private:
-	  RNG() : _seed(0) { time_seed(); };
+	  RNG() : _seed(0), _engine(0) { time_seed(); };
+	  RNG(unsigned int seed, unsigned int stream);
 	  RNG (const RNG& original);
 	  RNG& operator= (const RNG& rhs);
 	  void time_seed();
       unsigned int _seed;
+      EngineType _engine;
   };
 
 }
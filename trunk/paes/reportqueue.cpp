@@ -0,0 +1,232 @@
+#include "reportqueue.hpp"
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <clock.hpp>
+
+using namespace util;
+
+ReportQueue& ReportQueue::instance() {
+  // Never destroyed: writers held by static objects may still close
+  // their files after the exit handler stopped the thread.
+  static ReportQueue* queue=new ReportQueue();
+  return *queue;
+}
+
+ReportQueue::ReportQueue () :
+  _mutex(), _queued(), _dequeued(), _completed(),
+  _records(), _queuedBytes(0), _queuedSequence(0), _completedSequence(0),
+  _dirtyFiles(), _thread(), _running(false)
+{
+  if (pthread_create(&_thread, NULL, ReportQueue::ioMain, this) != 0) {
+	std::cerr << "Unable to start report thread, writing reports directly" << std::endl;
+	return;
+  }
+  _running=true;
+  atexit(ReportQueue::shutdownAtExit);
+}
+
+void ReportQueue::shutdownAtExit() {
+  instance().shutdown();
+}
+
+void* ReportQueue::ioMain(void* args) {
+  static_cast<ReportQueue*>(args)->ioLoop();
+  return NULL;
+}
+
+ReportQueue::FilePtr ReportQueue::open(const std::string& filename, const uint64_t offset) {
+  FilePtr file(new File());
+  file->name=filename;
+  file->offset=offset;
+  file->fd=-1;
+  file->failed=false;
+  file->dirty=false;
+  push(OPEN, file, std::string());
+  return file;
+}
+
+void ReportQueue::append(const FilePtr& file, const std::string& text) {
+  push(APPEND, file, text);
+}
+
+void ReportQueue::close(const FilePtr& file) {
+  push(CLOSE, file, std::string());
+}
+
+bool ReportQueue::sync(const FilePtr& file) {
+  uint64_t sequence=push(SYNC, file, std::string());
+  util::ScopedLock lock(_mutex);
+  while (_completedSequence < sequence)
+	_completed.wait(_mutex);
+  return ! file->failed;
+}
+
+void ReportQueue::shutdown() {
+  {
+	util::ScopedLock lock(_mutex);
+	if (! _running)
+	  return;
+  }
+  push(STOP, FilePtr(), std::string());
+  pthread_join(_thread, NULL);
+}
+
+uint64_t ReportQueue::push(Kind kind, const FilePtr& file, const std::string& text) {
+  util::ScopedLock lock(_mutex);
+  Record record;
+  record.kind=kind;
+  record.file=file;
+  record.text=text;
+  if (! _running) {
+	// no I/O thread (any more), write directly
+	std::vector<Record> records(1, record);
+	process(records);
+	_completedSequence=++_queuedSequence;
+	return _queuedSequence;
+  }
+  // a single record larger than the queue is accepted when it is empty
+  while (_queuedBytes > 0 && _queuedBytes + text.size() > MAX_QUEUED_BYTES)
+	_dequeued.wait(_mutex);
+  _records.push_back(record);
+  _queuedBytes += text.size();
+  _queued.signal();
+  return ++_queuedSequence;
+}
+
+void ReportQueue::ioLoop() {
+  long lastSync=util::getCurrentMilliseconds();
+  std::vector<Record> records;
+  bool stop=false;
+  while (! stop) {
+	uint64_t sequence;
+	{
+	  util::ScopedLock lock(_mutex);
+	  if (_records.empty())
+		_queued.wait(_mutex, SYNC_INTERVAL);
+	  records.assign(_records.begin(), _records.end());
+	  _records.clear();
+	  _queuedBytes=0;
+	  sequence=_queuedSequence;
+	  _dequeued.broadcast();
+	}
+	for (size_t i = 0; i < records.size(); i++) {
+	  if (records[i].kind == STOP)
+		stop=true;
+	}
+	process(records);
+	records.clear();
+	long now=util::getCurrentMilliseconds();
+	if (now - lastSync >= SYNC_INTERVAL) {
+	  syncDirtyFiles();
+	  lastSync=now;
+	}
+	util::ScopedLock lock(_mutex);
+	if (stop) {
+	  // from now on, push() writes directly
+	  _running=false;
+	  records.assign(_records.begin(), _records.end());
+	  _records.clear();
+	  _queuedBytes=0;
+	  process(records);
+	  sequence=_queuedSequence;
+	  _dequeued.broadcast();
+	}
+	_completedSequence=sequence;
+	_completed.broadcast();
+  }
+}
+
+/**
+ * Carries out the records in order. Consecutive appends to the same
+ * file are joined into one write.
+ */
+void ReportQueue::process(std::vector<Record>& records) {
+  std::string buffer;
+  for (size_t i = 0; i < records.size(); i++) {
+	Record& record=records[i];
+	switch (record.kind) {
+	  case OPEN:
+		openFile(*record.file);
+		break;
+	  case APPEND:
+		buffer.append(record.text);
+		if (i + 1 == records.size() || records[i+1].kind != APPEND ||
+			records[i+1].file != record.file) {
+		  writeFile(record.file, buffer);
+		  buffer.clear();
+		}
+		break;
+	  case SYNC:
+		syncFile(*record.file);
+		break;
+	  case CLOSE:
+		syncFile(*record.file);
+		if (record.file->fd >= 0)
+		  ::close(record.file->fd);
+		record.file->fd=-1;
+		break;
+	  case STOP:
+		syncDirtyFiles();
+		break;
+	}
+  }
+}
+
+void ReportQueue::openFile(File& file) {
+  file.fd=::open(file.name.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (file.fd < 0) {
+	std::cerr << "Unable to open file " << file.name << std::endl;
+	file.failed=true;
+	return;
+  }
+  struct stat st;
+  if (fstat(file.fd, &st) == 0 && (uint64_t) st.st_size < file.offset) {
+	// lines are missing, appending would misalign the rest
+	std::cerr << "File " << file.name << " is shorter than expected, not writing it." << std::endl;
+	file.failed=true;
+  } else if (ftruncate(file.fd, file.offset) != 0) {
+	std::cerr << "Unable to truncate file " << file.name << std::endl;
+	file.failed=true;
+  }
+}
+
+void ReportQueue::writeFile(const FilePtr& filePtr, const std::string& text) {
+  File& file=*filePtr;
+  if (file.fd < 0 || file.failed)
+	return;
+  const char* data=text.data();
+  size_t remaining=text.size();
+  while (remaining > 0) {
+	ssize_t written=::write(file.fd, data, remaining);
+	if (written < 0 && errno == EINTR)
+	  continue;
+	if (written <= 0) {
+	  std::cerr << "Unable to write file " << file.name << std::endl;
+	  file.failed=true;
+	  return;
+	}
+	data += written;
+	remaining -= written;
+  }
+  if (! file.dirty) {
+	file.dirty=true;
+	_dirtyFiles.push_back(filePtr);
+  }
+}
+
+void ReportQueue::syncFile(File& file) {
+  if (file.fd >= 0 && file.dirty && fsync(file.fd) != 0)
+	file.failed=true;
+  file.dirty=false;
+}
+
+void ReportQueue::syncDirtyFiles() {
+  for (size_t i = 0; i < _dirtyFiles.size(); i++) {
+	if (_dirtyFiles[i]->dirty)
+	  syncFile(*_dirtyFiles[i]);
+  }
+  _dirtyFiles.clear();
+}
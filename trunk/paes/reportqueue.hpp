@@ -0,0 +1,94 @@
+#ifndef PAES_REPORTQUEUE_HPP
+#define PAES_REPORTQUEUE_HPP 1
+
+#include <common.hpp>
+#include <mutex.hpp>
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+namespace util {
+  /**
+   * The I/O thread behind all ReportWriters. Writers queue text for
+   * their files, the thread appends it in queue order with one write()
+   * per file and batch, so a killed process leaves whole lines on disk.
+   * Files with new data are synced every SYNC_INTERVAL milliseconds and
+   * when they are closed.
+   *
+   * The queue holds at most MAX_QUEUED_BYTES of text. Writers never do
+   * disk I/O themselves, they only wait if the disk falls that far
+   * behind. Pending text is written when the process exits.
+   */
+  class ReportQueue {
+	public:
+	  /**
+	   * A file, owned by the I/O thread.
+	   */
+	  struct File {
+		std::string name;
+		uint64_t offset;
+		int fd;
+		bool failed;
+		bool dirty;
+	  };
+	  typedef std::tr1::shared_ptr<File> FilePtr;
+	  static const size_t MAX_QUEUED_BYTES = 8 * 1024 * 1024;
+	  static const long SYNC_INTERVAL = 10000;
+	  static ReportQueue& instance();
+	  /**
+	   * Opens the file, keeping its first offset bytes and dropping the
+	   * rest. If the file is shorter than offset, it fails: nothing is
+	   * written and sync() returns false.
+	   */
+	  FilePtr open(const std::string& filename, const uint64_t offset);
+	  void append(const FilePtr& file, const std::string& text);
+	  void close(const FilePtr& file);
+	  /**
+	   * Waits until everything queued for the file is on disk. Returns
+	   * false if the file could not be written.
+	   */
+	  bool sync(const FilePtr& file);
+	  /**
+	   * Writes all pending text and stops the I/O thread. Later
+	   * requests are carried out by the calling thread.
+	   */
+	  void shutdown();
+
+	private:
+	  enum Kind { OPEN, APPEND, SYNC, CLOSE, STOP };
+	  struct Record {
+		Kind kind;
+		FilePtr file;
+		std::string text;
+	  };
+	  ReportQueue ();
+	  virtual ~ReportQueue() {};
+	  ReportQueue (const ReportQueue& original);
+	  ReportQueue& operator= (const ReportQueue& rhs);
+	  static void* ioMain(void* args);
+	  static void shutdownAtExit();
+	  /**
+	   * Queues the record and returns its sequence number.
+	   */
+	  uint64_t push(Kind kind, const FilePtr& file, const std::string& text);
+	  void ioLoop();
+	  void process(std::vector<Record>& records);
+	  void openFile(File& file);
+	  void writeFile(const FilePtr& file, const std::string& text);
+	  void syncFile(File& file);
+	  void syncDirtyFiles();
+	  util::Mutex _mutex;
+	  util::Condition _queued;
+	  util::Condition _dequeued;
+	  util::Condition _completed;
+	  std::deque<Record> _records;
+	  size_t _queuedBytes;
+	  uint64_t _queuedSequence;
+	  uint64_t _completedSequence;
+	  std::vector<FilePtr> _dirtyFiles;
+	  pthread_t _thread;
+	  bool _running;
+  };
+}
+
+#endif /* PAES_REPORTQUEUE_HPP */
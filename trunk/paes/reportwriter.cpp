@@ -1,31 +1,38 @@
 #include "reportwriter.hpp"
-#include <fstream>
-#include <sstream>
 
 using namespace util;
 
+ReportWriter::ReportWriter (const std::string& outfile, const uint64_t offset) :
+  _outfile(outfile),
+  _file(util::ReportQueue::instance().open(outfile, offset)),
+  _size(offset)
+{ }
+
+ReportWriter::~ReportWriter() {
+  util::ReportQueue::instance().close(_file);
+}
+
+void ReportWriter::append(const std::string& text) {
+  util::ReportQueue::instance().append(_file, text);
+  _size += text.size();
+}
 
 void ReportWriter::addReportLine(const std::string& line) {
-  _reportLines.push_back(line);
+  append(line + "\n");
 }
 
 void ReportWriter::addHeaderLine(const std::string& line) {
-  _reportHeader.push_back(line);
+  append("# " + line + "\n");
 }
+
+bool ReportWriter::sync() {
+  return util::ReportQueue::instance().sync(_file);
+}
+
 void ReportWriter::writeReport() {
   std::cout << "Saving report to file " << _outfile << std::endl;
-  std::ofstream myfile (_outfile.c_str());
-  if (myfile.is_open()) {
-    std::vector<std::string>::iterator it;
-    for(it = _reportHeader.begin(); it < _reportHeader.end(); it++) {
-      myfile << "# " << (*it) << std::endl;
-    }
-    for(it = _reportLines.begin(); it < _reportLines.end(); it++) {
-      myfile << (*it) << std::endl;
-    }
-	myfile.close();
-  } else {
-	std::cerr << "Unable to open file, aborting" << std::endl; 
+  if (! sync()) {
+	std::cerr << "Unable to write file " << _outfile << ", aborting" << std::endl; 
 	exit(-1);
   }
 }
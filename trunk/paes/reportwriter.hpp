@@ -2,25 +2,50 @@
 #define PAES_REPORTWRITER_HPP 1
 
 #include <common.hpp>
-#include <vector>
+#include <reportqueue.hpp>
+#include <stdint.h>
 
 namespace util {
+  /**
+   * Streams header and report lines to a file through the report I/O
+   * thread, see ReportQueue. Lines appear in the file in the order they
+   * were added, nothing is kept in memory.
+   */
   class ReportWriter {
     public:
       typedef std::tr1::shared_ptr<ReportWriter> Ptr;
-      ReportWriter (const std::string& outfile) : 
-        _outfile(outfile), _reportHeader(), _reportLines() {};
-      virtual ~ReportWriter() {};
+      /**
+       * Creates or truncates the file. With an offset, the first offset
+       * bytes of an existing file are kept and the writer appends to
+       * them, e.g. to continue the report of a checkpointed run. A file
+       * shorter than the offset is not written at all.
+       */
+      ReportWriter (const std::string& outfile, const uint64_t offset = 0);
+      virtual ~ReportWriter();
       void addHeaderLine(const std::string& header);
       void addReportLine(const std::string& line);
+      /**
+       * Waits until all lines are on disk. Aborts if the file could
+       * not be written.
+       */
       void writeReport();
+      /**
+       * Waits until all lines are on disk, quietly. Returns false if the
+       * file could not be written.
+       */
+      bool sync();
+      /**
+       * The size of the file once all lines added so far are written.
+       */
+      uint64_t getSize() const { return _size; };
 
     private:
       ReportWriter (const ReportWriter& original);
       ReportWriter& operator= (const ReportWriter& rhs);
+      void append(const std::string& text);
       std::string _outfile;
-      std::vector<std::string> _reportHeader;
-      std::vector<std::string> _reportLines;
+      util::ReportQueue::FilePtr _file;
+      uint64_t _size;
   };
 }
 
@@ -0,0 +1,126 @@
+#include "reservationcalendar.hpp"
+#include <algorithm>
+#include <math.h>
+
+using namespace scheduler;
+
+/**
+ * Like JobQueue, reserves room for one more job. Each reservation adds
+ * at most two breakpoints.
+ */
+ReservationCalendar::ReservationCalendar (const ReservationCalendar& original) :
+  _steps(), _reservations(), _active(original._active)
+{
+  size_t capacity=original._reservations.size()+1;
+  if (_active) {
+	_steps.reserve(2 * capacity + 1);
+	_reservations.reserve(capacity);
+  }
+  _steps.assign(original._steps.begin(), original._steps.end());
+  _reservations.assign(original._reservations.begin(), original._reservations.end());
+}
+
+void ReservationCalendar::reset(const size_t positions) {
+  _steps.clear();
+  Step origin={ -HUGE_VAL, 0 };
+  _steps.push_back(origin);
+  Reservation none={ 0.0, 0.0, 0 };
+  _reservations.assign(positions, none);
+  _active=true;
+}
+
+void ReservationCalendar::insertPosition(const size_t position) {
+  if (! _active)
+	return;
+  Reservation none={ 0.0, 0.0, 0 };
+  _reservations.insert(_reservations.begin() + position, none);
+}
+
+void ReservationCalendar::erasePosition(const size_t position) {
+  if (! _active)
+	return;
+  const Reservation& old=_reservations[position];
+  if (old.nodes > 0)
+	add(old.start, old.end, old.nodes, true);
+  _reservations.erase(_reservations.begin() + position);
+}
+
+void ReservationCalendar::releaseFrom(const size_t position) {
+  for (size_t i=position; i < _reservations.size(); i++) {
+	Reservation& old=_reservations[i];
+	if (old.nodes > 0)
+	  add(old.start, old.end, old.nodes, true);
+	old.nodes=0;
+  }
+}
+
+void ReservationCalendar::reserve(const size_t position, const double start,
+	const double end, const unsigned int nodes) {
+  Reservation& current=_reservations[position];
+  if (current.nodes > 0)
+	add(current.start, current.end, current.nodes, true);
+  current.start=start;
+  current.end=end;
+  current.nodes=nodes;
+  if (nodes > 0)
+	add(start, end, nodes, false);
+}
+
+double ReservationCalendar::findEarliest(const double release, const double duration,
+	const unsigned int nodes, const unsigned int capacity) const {
+  double start=release;
+  size_t i=find(release);
+  // the last step is open-ended and free, so every job fits there
+  while (i < _steps.size()) {
+	if (_steps[i].used + nodes > capacity) {
+	  start=_steps[++i].time;
+	  continue;
+	}
+	if (i + 1 == _steps.size() || _steps[i + 1].time >= start + duration)
+	  return start;
+	i++;
+  }
+  return start;
+}
+
+size_t ReservationCalendar::find(const double time) const {
+  size_t low=0;
+  size_t high=_steps.size();
+  // _steps[low].time <= time < _steps[high].time
+  while (high - low > 1) {
+	size_t middle=low + (high - low) / 2;
+	if (_steps[middle].time <= time)
+	  low=middle;
+	else
+	  high=middle;
+  }
+  return low;
+}
+
+size_t ReservationCalendar::split(const double time) {
+  size_t i=find(time);
+  if (_steps[i].time == time)
+	return i;
+  Step step={ time, _steps[i].used };
+  _steps.insert(_steps.begin() + i + 1, step);
+  return i + 1;
+}
+
+void ReservationCalendar::add(const double start, const double end,
+	const unsigned int nodes, const bool release) {
+  if (! (start < end))
+	return;
+  size_t first=split(start);
+  size_t last=split(end);
+  for (size_t i=first; i < last; i++) {
+	if (release)
+	  _steps[i].used -= nodes;
+	else
+	  _steps[i].used += nodes;
+  }
+  // merge the breakpoints that no longer change the usage
+  if (_steps[last].used == _steps[last - 1].used)
+	_steps.erase(_steps.begin() + last);
+  if (first > 0 && _steps[first].used == _steps[first - 1].used)
+	_steps.erase(_steps.begin() + first);
+}
@@ -0,0 +1,79 @@
+#ifndef PAES_RESERVATIONCALENDAR_HPP
+#define PAES_RESERVATIONCALENDAR_HPP 1
+
+#include <common.hpp>
+#include <vector>
+
+namespace scheduler {
+  /**
+   * The node reservations of the jobs of one queue, for conservative
+   * backfilling. The reservations are kept per queue position, next to
+   * the times in the JobQueue, and summed up in a skyline: the number
+   * of reserved nodes as a step function of time, a sorted list of
+   * breakpoints.
+   *
+   * Finding the step of a time is a binary search. Reserving and
+   * releasing touch the steps the reservation covers, an earliest-fit
+   * query visits the steps between the release time and the start it
+   * finds. The calendar is a flat vector, so copying it with its queue
+   * is a memcpy.
+   */
+  class ReservationCalendar {
+	public:
+	  ReservationCalendar () : _steps(), _reservations(), _active(false) {};
+	  ReservationCalendar (const ReservationCalendar& original);
+	  virtual ~ReservationCalendar() {};
+	  /**
+	   * Empties the calendar and starts tracking a queue of the given
+	   * length. Until then, queue changes are ignored.
+	   */
+	  void reset(const size_t positions);
+	  bool isActive() const { return _active; };
+	  /**
+	   * A job was added to/removed from the queue at the position.
+	   * Removing releases the job's reservation.
+	   */
+	  void insertPosition(const size_t position);
+	  void erasePosition(const size_t position);
+	  /**
+	   * Releases the reservations of all positions from the given one
+	   * on.
+	   */
+	  void releaseFrom(const size_t position);
+	  void reserve(const size_t position, const double start, const double end,
+		  const unsigned int nodes);
+	  /**
+	   * The earliest time not before release at which nodes are free for
+	   * the duration, given the capacity of the resource.
+	   */
+	  double findEarliest(const double release, const double duration,
+		  const unsigned int nodes, const unsigned int capacity) const;
+
+	private:
+	  ReservationCalendar& operator= (const ReservationCalendar& rhs);
+	  struct Step {
+		double time;
+		unsigned int used;
+	  };
+	  struct Reservation {
+		double start;
+		double end;
+		unsigned int nodes;
+	  };
+	  /**
+	   * Returns the index of the step that starts at the time, splitting
+	   * the step containing it if necessary.
+	   */
+	  size_t split(const double time);
+	  /**
+	   * Index of the step containing the time.
+	   */
+	  size_t find(const double time) const;
+	  void add(const double start, const double end, const unsigned int nodes, const bool release);
+	  std::vector<Step> _steps;
+	  std::vector<Reservation> _reservations;
+	  bool _active;
+  };
+}
+
+#endif /* PAES_RESERVATIONCALENDAR_HPP */
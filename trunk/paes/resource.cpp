@@ -0,0 +1,20 @@
+#include "resource.hpp"
+#include <taintedstateexception.hpp>
+
+using namespace scheduler;
+
+Resource::AllocationListType Resource::getAllocations(
+	const scheduler::Workload::Ptr& workload,
+	scheduler::JobQueue& queue) const {
+  if (queue.isTainted())
+	throw TaintedStateException("Tainted: No up-to-date allocations available.");
+  AllocationListType retval;
+  const JobQueue::JobListType& jobs=queue.getJobs();
+  for (size_t i=0; i < jobs.size(); i++) {
+	Allocation::Ptr allocation(new Allocation(workload->getJobID(jobs[i]),
+		  queue.getStartTimes()[i], queue.getQueueTimes()[i],
+		  queue.getFinishTimes()[i], _pricingPlan->getPrice(*workload, jobs[i])));
+	retval.push_back(allocation);
+  }
+  return retval;
+}
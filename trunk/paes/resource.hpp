@@ -2,56 +2,74 @@
 #define PAES_RESOUCE_HPP 1
 
 #include <common.hpp>
-#include <job.hpp>
+#include <workload.hpp>
+#include <jobqueue.hpp>
 #include <pricingplan.hpp>
+#include <allocation.hpp>
+#include <vector>
 
 namespace scheduler {
  // class Job;
 /**
- * Interface for all resources.
+ * Interface for all resources. A resource only describes how jobs are
+ * scheduled and priced, the jobs themselves and the evaluation results
+ * are kept in the JobQueue of the schedule. Resources are never
+ * modified after the resource pool has been built.
  */
   class Resource {
 	public:
 	  typedef std::tr1::shared_ptr<Resource> Ptr;
 	  typedef unsigned int IDType;
+	  typedef std::vector<scheduler::Allocation::Ptr> AllocationListType;
 	  static const IDType RESOURCEID_MAX = UINT_MAX;
 	  Resource (IDType resourceID, const std::string& resourceName, 
 		  scheduler::PricingPlan::Ptr pricingPlan) :  
-		_resourceID(resourceID), _resourceName(resourceName), _tainted(true),
-		_totalQueueTime(0.0), _totalPrice(0.0), _pricingPlan(pricingPlan) {}; 
-	  Resource (const Resource& original) :
-		_resourceID(original.getResourceID()), 
-		_resourceName(original.getResourceName()), 
-		_tainted(original._tainted),
-		_totalQueueTime(original._totalQueueTime), 
-		_totalPrice(original._totalPrice),
-		_pricingPlan(original._pricingPlan) {}; 
+		_resourceID(resourceID), _resourceName(resourceName),
+		_pricingPlan(pricingPlan) {}; 
 	  virtual ~Resource() {};
 	  virtual const std::string str() = 0;
 	  const IDType getResourceID() const { return _resourceID; };
 	  const std::string getResourceName() const { return _resourceName; };
-	  const bool isTainted() { return _tainted; };
-
-	  virtual void addJob(const scheduler::Job::Ptr& job) = 0;
-	  virtual void reSchedule()=0;
-	  virtual bool sanityCheck() =0;
-	  virtual void removeAllJobs()=0;
-	  virtual const double getTotalQueueTime()=0;
-	  virtual const double getTotalPrice()=0; 
+	  /**
+	   * The price of a job on this resource. Schedules look prices up in
+	   * the PriceTable of the resource pool instead.
+	   */
+	  double getPrice(const scheduler::Workload& workload,
+		  const scheduler::Workload::IndexType& jobIndex) const {
+		return _pricingPlan->getPrice(workload, jobIndex);
+	  };
 
+	  /**
+	   * Schedules the jobs of the queue on this resource and stores the
+	   * times in the queue. Implementations must not allocate memory,
+	   * this is called for every evaluation.
+	   */
+	  virtual void reSchedule(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const =0;
+	  virtual bool sanityCheck(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const =0;
+	  /**
+	   * True if the queues of this resource are plain FCFS queues on a
+	   * single machine, which Schedule may evaluate several at a time
+	   * with fcfs::evaluate() instead of calling reSchedule().
+	   */
+	  virtual bool isFCFS() const { return false; };
+	  /**
+	   * Builds the allocations of an evaluated queue, in queue order.
+	   * Only meant for sanity checks and reporting.
+	   */
+	  AllocationListType getAllocations(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const;
 
 	private:
+	  Resource (const Resource& original);
 	  Resource& operator= (const Resource& rhs);
 	  IDType _resourceID;
 	  std::string _resourceName;
 	protected:
-	  bool _tainted;
-	  double _totalQueueTime;
-	  double _totalPrice;
 	  scheduler::PricingPlan::Ptr _pricingPlan;
   };
 
 }
 
 #endif /* PAES_RESOUCE_HPP */
-
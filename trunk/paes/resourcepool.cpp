@@ -1,54 +1,160 @@
 #include "resourcepool.hpp"
 #include <random.hpp>
 #include <sstream>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace scheduler;
 
-void ResourcePool::add(const scheduler::Resource::Ptr resource) {
+const ResourcePool::IndexType ResourcePool::NO_INDEX;
+
+namespace {
+  // the id table may have this many entries per resource
+  const size_t MAX_IDS_PER_RESOURCE = 4;
+
+  const Resource::Ptr NO_RESOURCE;
+
+  struct IDLess {
+	bool operator() (const Resource::Ptr& resource, const Resource::IDType& id) const {
+	  return resource->getResourceID() < id;
+	}
+  };
+}
+
+void ResourcePool::add(const scheduler::Resource::Ptr resource, const double weight) {
+  if (! (weight > 0.0))
+	throw std::invalid_argument("Resource " + resource->getResourceName() + " needs a positive weight");
   Resource::IDType currentID(resource->getResourceID());
-  _resources[currentID]=resource;
-  if (currentID < _minResourceID) 
-	_minResourceID = currentID;
-  if (currentID > _maxResourceID)
-	_maxResourceID = currentID;
+  ResourceListType::iterator it=std::lower_bound(_resources.begin(), _resources.end(),
+	  currentID, IDLess());
+  IndexType index=it - _resources.begin();
+  if (it != _resources.end() && (*it)->getResourceID() == currentID) {
+	(*it)=resource;
+	_weights[index]=weight;
+	_weighted=false;
+	for (size_t i=1; i < _weights.size(); i++)
+	  _weighted = _weighted || _weights[i] != _weights[0];
+  } else {
+	_resources.insert(it, resource);
+	_weights.insert(_weights.begin() + index, weight);
+	_weighted = _weighted || weight != _weights[0];
+  }
+  reindex(index);
+}
+
+/**
+ * Appending a resource with a higher id only extends the tables. Other
+ * insertions shift the indices after the new resource.
+ */
+void ResourcePool::reindex(const IndexType& first) {
+  _cumulativeWeights.resize(_resources.size());
+  double sum=(first > 0) ? _cumulativeWeights[first - 1] : 0.0;
+  for (size_t i=first; i < _resources.size(); i++) {
+	sum += _weights[i];
+	_cumulativeWeights[i]=sum;
+  }
+  Resource::IDType minID=_resources.front()->getResourceID();
+  Resource::IDType maxID=_resources.back()->getResourceID();
+  size_t span=(size_t) (maxID - minID) + 1;
+  if (span / MAX_IDS_PER_RESOURCE > _resources.size()) {
+	_indices.clear();
+	_minResourceID=minID;
+	return;
+  }
+  IndexType from=first;
+  if (_indices.empty() || minID != _minResourceID) {
+	_indices.assign(span, NO_INDEX);
+	from=0;
+  } else {
+	_indices.resize(span, NO_INDEX);
+  }
+  _minResourceID=minID;
+  for (size_t i=from; i < _resources.size(); i++)
+	_indices[_resources[i]->getResourceID() - _minResourceID]=i;
+}
+
+ResourcePool::IndexType ResourcePool::getIndex(const scheduler::Resource::IDType& id) const {
+  if (_resources.empty() || id < _minResourceID)
+	return NO_INDEX;
+  if (! _indices.empty()) {
+	size_t offset=id - _minResourceID;
+	return offset < _indices.size() ? _indices[offset] : NO_INDEX;
+  }
+  ResourceListType::const_iterator it=std::lower_bound(_resources.begin(), _resources.end(),
+	  id, IDLess());
+  if (it == _resources.end() || (*it)->getResourceID() != id)
+	return NO_INDEX;
+  return it - _resources.begin();
+}
+
+const scheduler::Resource::Ptr& ResourcePool::getResourceByID(const scheduler::Resource::IDType& id) const {
+  IndexType index=getIndex(id);
+  if (index == NO_INDEX)
+	return NO_RESOURCE;
+  return _resources[index];
 }
 
-scheduler::Resource::Ptr ResourcePool::getResourceByID(const scheduler::Resource::IDType& id) {
-  Resource::Ptr retval(_resources[id]);
-  return retval;
+/**
+ * Draws an index in proportion to the weights. A skipped index is cut
+ * out of the range of the draw, so no retries are needed.
+ */
+ResourcePool::IndexType ResourcePool::drawIndex(const double& total, const IndexType& skip) const {
+  util::RNG& rng=util::RNG::instance();
+  double value=rng.uniform_deviate() * total;
+  if (skip != NO_INDEX) {
+	double before=(skip > 0) ? _cumulativeWeights[skip - 1] : 0.0;
+	if (value >= before)
+	  value += _weights[skip];
+  }
+  IndexType index=std::upper_bound(_cumulativeWeights.begin(), _cumulativeWeights.end(), value)
+	- _cumulativeWeights.begin();
+  if (index >= _resources.size())
+	index=_resources.size() - 1;
+  // rounding at the borders of the skipped range
+  if (index == skip)
+	index=(skip + 1 < _resources.size()) ? skip + 1 : skip - 1;
+  return index;
 }
 
 scheduler::Resource::IDType ResourcePool::getRandomResourceID() {
+  assert(! _resources.empty());
+  if (_weighted)
+	return _resources[drawIndex(_cumulativeWeights.back(), NO_INDEX)]->getResourceID();
   util::RNG& rng=util::RNG::instance();
-  return rng.uniform_derivate_ranged_int(_minResourceID, _maxResourceID);
+  return _resources[rng.uniform_derivate_ranged_int(0, _resources.size() - 1)]->getResourceID();
 }
 
-std::vector<scheduler::Resource::Ptr> ResourcePool::getAllResources() {
-  std::vector<scheduler::Resource::Ptr> retval;
-  ResourceIteratorType it;
-  for (it=_resources.begin(); it != _resources.end(); it++) {
-	retval.push_back((*it).second);
+scheduler::Resource::IDType ResourcePool::getRandomResourceID(const scheduler::Resource::IDType& exclude) {
+  assert(_resources.size() > 1);
+  IndexType skip=getIndex(exclude);
+  if (skip == NO_INDEX)
+	return getRandomResourceID();
+  if (_weighted)
+	return _resources[drawIndex(_cumulativeWeights.back() - _weights[skip], skip)]->getResourceID();
+  util::RNG& rng=util::RNG::instance();
+  // draw from one index less and skip the excluded one - no retries needed.
+  IndexType index=rng.uniform_derivate_ranged_int(0, _resources.size() - 2);
+  if (index >= skip)
+	index++;
+  return _resources[index]->getResourceID();
+}
+
+scheduler::PriceTable::Ptr ResourcePool::getPriceTable(const scheduler::Workload::Ptr& workload) {
+  util::ScopedLock lock(_priceMutex);
+  if (! _priceTable || _pricedWorkload != workload) {
+	_priceTable=PriceTable::Ptr(new PriceTable(workload, _resources));
+	_pricedWorkload=workload;
   }
-  return retval;
+  return _priceTable;
 }
 
 const std::string ResourcePool::str() {
   std::ostringstream oss;
-  oss << "Resourcepool of " << _resources.size() <<" resources:"; 
-  ResourceIteratorType it;
-  for (it=_resources.begin(); it != _resources.end(); it++) {
-	oss << std::endl << (*it).second->str();
+  oss << "Resourcepool of " << _resources.size() <<" resources:";
+  for (size_t i=0; i < _resources.size(); i++) {
+	oss << std::endl << _resources[i]->str();
+	if (_weighted)
+	  oss << ", weight " << _weights[i];
   }
   return oss.str();
 }
-
-bool ResourcePool::sanityCheck() {
-  bool success=true;
-  std::vector<scheduler::Resource::Ptr> resourceList = getAllResources();
-  std::vector<scheduler::Resource::Ptr>::iterator it; 
-  for(  it = resourceList.begin(); it < resourceList.end(); it++) {
-	if (! (*it)->sanityCheck())
-	  success = false;
-  }
-  return success;
-}
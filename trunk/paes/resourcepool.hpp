@@ -3,33 +3,85 @@
 
 #include <common.hpp>
 #include <resource.hpp>
-#include <map>
+#include <pricetable.hpp>
+#include <mutex.hpp>
 #include <vector>
 
 namespace scheduler {
+  /**
+   * The resources of the grid. The pool is built once at startup and
+   * shared read-only by all schedules.
+   *
+   * Resources are kept in a vector ordered by id. A resource's position
+   * in it is its index, which does not change once the pool is built.
+   * Ids need not be contiguous. An id is mapped to its index by a table
+   * over the id range in constant time, or by a binary search in
+   * O(log n) if the ids are too sparse for a table.
+   *
+   * Random resources are drawn uniformly in constant time, or in
+   * proportion to their weights if the weights differ. A weighted draw
+   * binary-searches the cumulative weights and costs O(log n).
+   */
   class ResourcePool {
 	public:
 	  typedef std::tr1::shared_ptr<ResourcePool> Ptr;
-	  typedef std::map<scheduler::Resource::IDType, scheduler::Resource::Ptr>::iterator ResourceIteratorType;
-	  ResourcePool() : 
-		_resources(), 
+	  typedef std::vector<scheduler::Resource::Ptr> ResourceListType;
+	  typedef size_t IndexType;
+	  static const IndexType NO_INDEX = (size_t) -1;
+	  ResourcePool() :
+		_resources(), _weights(), _cumulativeWeights(), _indices(),
 		_minResourceID(scheduler::Resource::RESOURCEID_MAX),
-		_maxResourceID(0) {};
+		_weighted(false),
+		_pricedWorkload(), _priceTable(), _priceMutex() {};
 	  virtual ~ResourcePool() {};
-	  void add(const scheduler::Resource::Ptr resource);
+	  /**
+	   * Adds or replaces the resource with the id of the given one. The
+	   * weight is its share of random draws, it must be positive.
+	   */
+	  void add(const scheduler::Resource::Ptr resource, const double weight=1.0);
 	  scheduler::Resource::IDType getRandomResourceID();
-	  scheduler::Resource::Ptr getResourceByID(const scheduler::Resource::IDType& id);
-	  std::vector<scheduler::Resource::Ptr> getAllResources();
+	  /**
+	   * Returns a random resource id different from the given one.
+	   */
+	  scheduler::Resource::IDType getRandomResourceID(const scheduler::Resource::IDType& exclude);
+	  /**
+	   * Returns an empty pointer if there is no resource with the id.
+	   */
+	  const scheduler::Resource::Ptr& getResourceByID(const scheduler::Resource::IDType& id) const;
+	  /**
+	   * Returns NO_INDEX if there is no resource with the id.
+	   */
+	  IndexType getIndex(const scheduler::Resource::IDType& id) const;
+	  const scheduler::Resource::Ptr& getResource(const IndexType& index) const { return _resources[index]; };
+	  const ResourceListType& getAllResources() const { return _resources; };
+	  /**
+	   * Returns the prices of the jobs of the workload on these
+	   * resources. The table is built by the first call for a workload,
+	   * resources must not be added afterwards.
+	   */
+	  scheduler::PriceTable::Ptr getPriceTable(const scheduler::Workload::Ptr& workload);
 	  const std::string str();
-	  const size_t size() { return _resources.size(); };
-	  bool sanityCheck();
+	  size_t size() const { return _resources.size(); };
 
 	private:
 	  ResourcePool (const ResourcePool& original);
 	  ResourcePool& operator= (const ResourcePool& rhs);
-	  std::map<scheduler::Resource::IDType, scheduler::Resource::Ptr> _resources;
+	  /**
+	   * Rebuilds the id table and the cumulative weights from the given
+	   * index on.
+	   */
+	  void reindex(const IndexType& first);
+	  IndexType drawIndex(const double& total, const IndexType& skip) const;
+	  ResourceListType _resources;
+	  std::vector<double> _weights;
+	  std::vector<double> _cumulativeWeights;
+	  // index by id - _minResourceID, empty if the ids are too sparse
+	  std::vector<IndexType> _indices;
 	  scheduler::Resource::IDType _minResourceID;
-	  scheduler::Resource::IDType _maxResourceID;
+	  bool _weighted;
+	  scheduler::Workload::Ptr _pricedWorkload;
+	  scheduler::PriceTable::Ptr _priceTable;
+	  util::Mutex _priceMutex;
   };
 }
 
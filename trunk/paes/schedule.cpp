@@ -1,46 +1,110 @@
 #include "schedule.hpp"
 #include <random.hpp>
+#include <telemetry.hpp>
+#include <fcfsscan.hpp>
+#include <taskpool.hpp>
 #include <sstream>
 #include <utility>
+#include <stdexcept>
 
 
 using namespace scheduler;
 
+namespace {
+  /**
+   * A share of the evaluation of a schedule: fcfs::LANES new FCFS queues,
+   * or one queue evaluated by its resource.
+   */
+  struct QueueGroup {
+	scheduler::JobQueue* queues[fcfs::LANES];
+	size_t count;
+	const scheduler::Resource* resource;
+  };
+
+  class EvaluationTask : public util::TaskPool::Task {
+	public:
+	  EvaluationTask (const scheduler::Workload::Ptr& workload,
+		  const std::vector<QueueGroup>& groups) :
+		_workload(workload), _groups(groups) {};
+	  void run(const size_t index) {
+		const QueueGroup& group=_groups[index];
+		if (group.resource == NULL)
+		  fcfs::evaluate(*_workload, group.queues, group.count);
+		else
+		  group.resource->reSchedule(_workload, *group.queues[0]);
+	  };
+	private:
+	  const scheduler::Workload::Ptr& _workload;
+	  const std::vector<QueueGroup>& _groups;
+  };
+}
+
 Schedule::Schedule (const scheduler::Workload::Ptr& workload,
 	const scheduler::ResourcePool::Ptr& resources) : 
   _workload(workload),  
   _resources(resources),  
+  _prices(resources->getPriceTable(workload)),
   _schedule(), 
+  _queues(),
+  _taintedQueues(),
+  _location(0),
   _tainted(true),
   _totalQueueTime(0.0),
-  _totalPrice(0.0)
+  _totalPrice(0.0),
+  _queueTimeSum(0),
+  _priceSum(0)
 { }
 
 /**
- * Copy constructor - copies the exact state of the current schedule,
- * assigns jobs to the resources.
+ * Copy constructor - copies the exact state of the current schedule.
+ * The assignment and the job queues are shared with the original until
+ * mutate() copies the parts it modifies.
  */
 Schedule::Schedule (const Schedule& original) :
   _workload(original._workload),  
   _resources(original._resources),  
+  _prices(original._prices),
   _schedule(original._schedule),
+  _queues(original._queues),
+  _taintedQueues(original._taintedQueues),
+  _location(0),
   _tainted(original._tainted),
   _totalQueueTime(original._totalQueueTime),
-  _totalPrice(original._totalPrice)
+  _totalPrice(original._totalPrice),
+  _queueTimeSum(original._queueTimeSum),
+  _priceSum(original._priceSum)
 {
   //propagateJobsToResources();
   //_tainted=false;
 }
 
 void Schedule::randomSchedule() {
-  std::vector<scheduler::Job::IDType> jobIDs = _workload->getJobIDs();
-  std::vector<scheduler::Job::IDType>::iterator it;
-  for(  it = jobIDs.begin(); it < jobIDs.end(); it++) {
+  AssignmentType assignment;
+  for( size_t i = 0; i < _workload->size(); i++) {
 	scheduler::Resource::IDType resourceID=_resources->getRandomResourceID();
-	SchedulePairType allocation=std::make_pair((*it), resourceID);
-	_schedule.push_back(allocation);
+	assignment.push_back(resourceID);
   }
-  _tainted=true;
+  _schedule=AssignmentTree(assignment);
+  removeAllJobs();
+}
+
+void Schedule::setAssignment(const AssignmentType& assignment) {
+  if (assignment.size() != _workload->size()) {
+	std::ostringstream oss;
+	oss << "Assignment of " << assignment.size() << " jobs does not match workload of ";
+	oss << _workload->size() << " jobs.";
+	throw std::invalid_argument(oss.str());
+  }
+  AssignmentType::const_iterator it;
+  for(  it = assignment.begin(); it < assignment.end(); it++) {
+	if (! _resources->getResourceByID(*it)) {
+	  std::ostringstream oss;
+	  oss << "Assignment refers to unknown resource " << (*it);
+	  throw std::invalid_argument(oss.str());
+	}
+  }
+  _schedule=AssignmentTree(assignment);
+  removeAllJobs();
 }
 
 /**
@@ -48,20 +112,52 @@ void Schedule::randomSchedule() {
  * resource.
  */
 void Schedule::mutate() {
+  if (_queues.empty())
+	propagateJobsToQueues();
   util::RNG& rng=util::RNG::instance();
-  size_t jobIndex = rng.uniform_derivate_ranged_int(0, _schedule.size()-1);
-  scheduler::Resource::IDType oldResourceID=_schedule[jobIndex].second;
-  scheduler::Resource::IDType newResourceID;
-  do {
-	newResourceID=_resources->getRandomResourceID();
-  } while (newResourceID == oldResourceID);
+  scheduler::Workload::IndexType jobIndex = rng.uniform_derivate_ranged_int(0, _schedule.size()-1);
+  scheduler::Resource::IDType oldResourceID=_schedule.get(jobIndex);
+  scheduler::Resource::IDType newResourceID=_resources->getRandomResourceID(oldResourceID);
   //std::cout << "Jobindex " << jobIndex << ": Swapping resource " << oldResourceID << " to " << newResourceID << std::endl;
-  _schedule[jobIndex].second = newResourceID;
-  //TODO: Do this only for the old and new resource - the others are not tainted.
-  propagateJobsToResources();
+  _schedule.set(jobIndex, newResourceID);
+  moveJob(jobIndex, _resources->getIndex(oldResourceID), _resources->getIndex(newResourceID));
   _tainted=true;
 }
 
+/**
+ * Replaces the queues of both resources with modified copies - the
+ * originals may still be referenced by other schedules. The price sum
+ * changes by the difference of the job's prices.
+ */
+void Schedule::moveJob(const scheduler::Workload::IndexType& jobIndex,
+	const scheduler::ResourcePool::IndexType& oldIndex,
+	const scheduler::ResourcePool::IndexType& newIndex) {
+  taint(oldIndex);
+  taint(newIndex);
+  JobQueue::Ptr oldQueue(new JobQueue(*_queues[oldIndex]));
+  oldQueue->removeJob(jobIndex);
+  _queues[oldIndex]=oldQueue;
+  JobQueue::Ptr newQueue(new JobQueue(*_queues[newIndex]));
+  newQueue->addJob(jobIndex);
+  _queues[newIndex]=newQueue;
+  _priceSum += _prices->getPrice(jobIndex, newIndex);
+  _priceSum -= _prices->getPrice(jobIndex, oldIndex);
+}
+
+/**
+ * Takes the queue time of the queue out of the total until the next
+ * update evaluates the queue again. Queues that are already waiting
+ * for it are not in the total.
+ */
+void Schedule::taint(const scheduler::ResourcePool::IndexType& index) {
+  for( size_t i = 0; i < _taintedQueues.size(); i++) {
+	if (_taintedQueues[i] == index)
+	  return;
+  }
+  _queueTimeSum -= _queues[index]->getQueueTimeSum();
+  _taintedQueues.push_back(index);
+}
+
 
 const std::string Schedule::str() {
   std::ostringstream oss;
@@ -77,27 +173,35 @@ const std::string Schedule::str() {
 const std::string Schedule::getAllocationTable() {
   std::ostringstream oss;
   oss << "current allocations: " << _workload->size() << " jobs, "<< _resources->size() << " resources." << std::endl;
-  oss << "job id\tresource id" << std::endl;
-  std::vector<SchedulePairType>::iterator it;
-  for(  it = _schedule.begin(); it < _schedule.end(); it++) {
-	scheduler::Job::IDType jobID=(*it).first;
-	scheduler::Resource::IDType resourceID=(*it).second;
-	oss << jobID << "\t" << resourceID << std::endl;
+  if (_tainted)
+	update();
+  oss << "job id\tresource id\tstart\tqueue\tfinish\tprice" << std::endl;
+  for( size_t i = 0; i < _queues.size(); i++) {
+	const scheduler::Resource::Ptr& resource=_resources->getResource(i);
+	scheduler::Resource::AllocationListType allocations=resource->getAllocations(_workload, *_queues[i]);
+	scheduler::Resource::AllocationListType::iterator ait;
+	for( ait = allocations.begin(); ait < allocations.end(); ait++) {
+	  oss << (*ait)->getJobID() << "\t" << resource->getResourceID() << "\t" << (*ait)->getStartTime();
+	  oss << "\t" << (*ait)->getQueueTime() << "\t" << (*ait)->getFinishTime();
+	  oss << "\t" << (*ait)->getPrice() << std::endl;
+	}
   }
   return oss.str();
 }
 
-void Schedule::propagateJobsToResources() {
+void Schedule::propagateJobsToQueues() {
+  TELEMETRY_TIMER(PROPAGATE);
   removeAllJobs();
-  std::vector<Schedule::SchedulePairType>::iterator it;
-  for(  it = _schedule.begin(); it < _schedule.end(); it++) {
-	scheduler::Job::IDType jobID=(*it).first;
-	scheduler::Job::Ptr job=_workload->getJobByID(jobID);
-	scheduler::Resource::IDType resourceID=(*it).second;
-	scheduler::Resource::Ptr resource = _resources->getResourceByID(resourceID);
-	resource->addJob(job);
+  for( size_t i = 0; i < _resources->size(); i++) {
+	_queues.push_back(JobQueue::Ptr(new JobQueue()));
+	_taintedQueues.push_back(i);
+  }
+  _priceSum=0;
+  for( size_t i = 0; i < _schedule.size(); i++) {
+	ResourcePool::IndexType index=_resources->getIndex(_schedule.get(i));
+	_queues[index]->addJob(i);
+	_priceSum += _prices->getPrice(i, index);
   }
-  _tainted=true;
 }
 
 scheduler::Schedule::DOMINATION Schedule::compare(const Schedule::Ptr& other) {
@@ -133,33 +237,116 @@ bool Schedule::equals(const Schedule::Ptr& other) {
 }
 
 void Schedule::removeAllJobs() {
-  std::vector<scheduler::Resource::Ptr> resourceList = _resources->getAllResources();
-  std::vector<scheduler::Resource::Ptr>::iterator it; 
-  for(  it = resourceList.begin(); it < resourceList.end(); it++) {
-	(*it)->removeAllJobs();
-  }
+  _queues.clear();
+  _taintedQueues.clear();
+  _queueTimeSum=0;
   _tainted=true;
 }
 
+/**
+ * Evaluates the tainted queues only. New FCFS queues, e.g. all queues
+ * of a new assignment, are evaluated fcfs::LANES at a time. Large
+ * evaluations are split over the task pool first. The total queue
+ * time gets the new sums of these queues back. The queue time and
+ * price sums are exact, so the totals do not depend on the sequence of
+ * mutations that led to this schedule.
+ */
 void Schedule::processSchedule() {
-  _totalQueueTime=_totalPrice=0.0;
-  std::vector<scheduler::Resource::Ptr> resourceList = _resources->getAllResources();
-  std::vector<scheduler::Resource::Ptr>::iterator it; 
-  for(  it = resourceList.begin(); it < resourceList.end(); it++) {
-	if ((*it)->isTainted()) {
-	  (*it)->reSchedule();
+  TELEMETRY_TIMER(RESCHEDULE);
+  _totalPrice=PriceTable::toDouble(_priceSum);
+  std::vector<ResourcePool::IndexType>::const_iterator it;
+  if (util::TaskPool::instance().getThreads() > 1) {
+	size_t taintedJobs=0;
+	for(  it = _taintedQueues.begin(); it != _taintedQueues.end(); it++) {
+	  if (_queues[*it]->isTainted())
+		taintedJobs += _queues[*it]->size();
 	}
-	_totalQueueTime += (*it)->getTotalQueueTime();
-	_totalPrice += (*it)->getTotalPrice();
+	if (taintedJobs >= PARALLEL_JOBS)
+	  processScheduleParallel();
   }
+  JobQueue* batch[fcfs::LANES];
+  size_t batched=0;
+  for(  it = _taintedQueues.begin(); it != _taintedQueues.end(); it++) {
+	JobQueue& queue=*_queues[*it];
+	if (! queue.isTainted())
+	  continue;
+	const scheduler::Resource::Ptr& resource=_resources->getResource(*it);
+	if (resource->isFCFS() && queue.needsFullEvaluation()) {
+	  batch[batched++]=&queue;
+	  if (batched == fcfs::LANES) {
+		fcfs::evaluate(*_workload, batch, batched);
+		batched=0;
+	  }
+	} else {
+	  resource->reSchedule(_workload, queue);
+	}
+  }
+  fcfs::evaluate(*_workload, batch, batched);
+  for(  it = _taintedQueues.begin(); it != _taintedQueues.end(); it++) {
+	_queueTimeSum += _queues[*it]->getQueueTimeSum();
+  }
+  _taintedQueues.clear();
+  _totalQueueTime=JobQueue::toDouble(_queueTimeSum);
   _tainted=false;
 }
 
+/**
+ * Evaluates the tainted queues in the task pool. Each queue is evaluated
+ * by one thread with the same code as in the serial path, and the totals
+ * are exact sums, so the results do not depend on the number of threads.
+ * If the pool is busy, the groups are evaluated here.
+ */
+void Schedule::processScheduleParallel() {
+  std::vector<QueueGroup> groups;
+  QueueGroup batch;
+  batch.count=0;
+  batch.resource=NULL;
+  std::vector<ResourcePool::IndexType>::const_iterator it;
+  for(  it = _taintedQueues.begin(); it != _taintedQueues.end(); it++) {
+	JobQueue& queue=*_queues[*it];
+	if (! queue.isTainted())
+	  continue;
+	const scheduler::Resource* resource=_resources->getResource(*it).get();
+	if (resource->isFCFS() && queue.needsFullEvaluation()) {
+	  batch.queues[batch.count++]=&queue;
+	  if (batch.count == fcfs::LANES) {
+		groups.push_back(batch);
+		batch.count=0;
+	  }
+	} else {
+	  QueueGroup single;
+	  single.queues[0]=&queue;
+	  single.count=1;
+	  single.resource=resource;
+	  groups.push_back(single);
+	}
+  }
+  if (batch.count > 0)
+	groups.push_back(batch);
+  EvaluationTask task(_workload, groups);
+  if (! util::TaskPool::instance().run(task, groups.size())) {
+	for (size_t i=0; i < groups.size(); i++)
+	  task.run(i);
+  }
+}
+
 void Schedule::update() {
-  propagateJobsToResources();
+  if (_queues.empty())
+	propagateJobsToQueues();
   processSchedule();
 }
 
+bool Schedule::sanityCheck() {
+  bool success=true;
+  if (_tainted)
+	update();
+  for( size_t i = 0; i < _queues.size(); i++) {
+	if (! _resources->getResource(i)->sanityCheck(_workload, *_queues[i]))
+	  success = false;
+  }
+  return success;
+}
+
 const double Schedule::getTotalQueueTime() {
   if (_tainted) {
 	// update the resources
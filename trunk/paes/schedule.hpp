@@ -3,10 +3,13 @@
 #include <common.hpp>
 #include <config.hpp>
 #include <vector>
-#include <bitset>
+#include <stdint.h>
 #include <simpleresource.hpp>
 #include <resourcepool.hpp>
+#include <pricetable.hpp>
 #include <workload.hpp>
+#include <jobqueue.hpp>
+#include <assignmenttree.hpp>
 
 
 namespace scheduler {
@@ -16,15 +19,39 @@ namespace scheduler {
 		DOMINATES, IS_DOMINATED, NO_DOMINATION
 	  } my_Domination;
 	  typedef std::tr1::shared_ptr<Schedule> Ptr;
-	  typedef std::pair<scheduler::Job::IDType, scheduler::SimpleResource::IDType> SchedulePairType;
-	  typedef std::bitset<config::NUM_LOCATION_BITS> LocationType;
-	  typedef std::bitset<config::LOCATION_DIMENSION_SIZE> LocationDimensionType;
+	  /**
+	   * The cell of the adaptive grid, see AdaptiveGrid.
+	   */
+	  typedef uint64_t LocationType;
+	  /**
+	   * The job queues, indexed by resource pool index.
+	   */
+	  typedef std::vector<scheduler::JobQueue::Ptr> QueueListType;
+	  /**
+	   * Tainted queues with at least this many jobs in total are
+	   * evaluated by the util::TaskPool, if it has more than one thread.
+	   */
+	  static const size_t PARALLEL_JOBS = 65536;
 	  Schedule (const scheduler::Workload::Ptr& workload, const scheduler::ResourcePool::Ptr& resources);
 	  Schedule (const Schedule& original); 
 	  virtual ~Schedule() {};
 	  const std::string str();
+	  /**
+	   * Lists the allocation of every job, grouped by resource.
+	   */
 	  const std::string getAllocationTable();
 	  void randomSchedule();
+	  typedef scheduler::AssignmentTree::ListType AssignmentType;
+	  /**
+	   * The resource of each job, indexed by job index. The list is
+	   * built from the shared assignment on every call.
+	   */
+	  AssignmentType getAssignment() const { return _schedule.getValues(); };
+	  /**
+	   * Replaces the job to resource mapping. Throws std::invalid_argument
+	   * if the size does not match the workload or a resource is unknown.
+	   */
+	  void setAssignment(const AssignmentType& assignment);
 	  /**
 	   * Compares this schedule to another one.
 	   * returns 
@@ -35,26 +62,53 @@ namespace scheduler {
 	  DOMINATION compare(const Schedule::Ptr& other);
 	  bool dominates(const Schedule::Ptr& other);
 	  bool equals(const Schedule::Ptr& other);
+	  /**
+	   * Moves a random job to a different resource. Only the queues of
+	   * the old and the new resource are tainted, the next update
+	   * evaluates just these two and adjusts the total queue time by
+	   * the change of their sums.
+	   */
 	  void mutate();
 	  void update();
+	  /**
+	   * Checks the allocations of all resources, returns true if they
+	   * are valid.
+	   */
+	  bool sanityCheck();
 	  void removeAllJobs();
 	  const double getTotalQueueTime();
 	  const double getTotalPrice();
 	  const bool isTainted() { return _tainted; };
-	  LocationType getLocation() { return _location; };
-	  void setLocation(LocationType location) { _location=location; };
+	  LocationType getLocation() const { return _location; };
+	  void setLocation(const LocationType& location) { _location=location; };
+	  const scheduler::Workload::Ptr& getWorkload() const { return _workload; };
+	  const scheduler::ResourcePool::Ptr& getResources() const { return _resources; };
 
 	private:
-	  void propagateJobsToResources();
+	  void propagateJobsToQueues();
+	  void moveJob(const scheduler::Workload::IndexType& jobIndex,
+		  const scheduler::ResourcePool::IndexType& oldIndex,
+		  const scheduler::ResourcePool::IndexType& newIndex);
+	  void taint(const scheduler::ResourcePool::IndexType& index);
 	  void processSchedule();
+	  void processScheduleParallel();
 	  Schedule& operator= (const Schedule& rhs);
 	  scheduler::Workload::Ptr _workload;
 	  scheduler::ResourcePool::Ptr _resources;
-	  std::vector<SchedulePairType> _schedule;
+	  scheduler::PriceTable::Ptr _prices;
+	  scheduler::AssignmentTree _schedule;
+	  QueueListType _queues;
+	  // the queues changed since the last update, their queue times are
+	  // not part of _queueTimeSum
+	  std::vector<scheduler::ResourcePool::IndexType> _taintedQueues;
 	  LocationType _location;
 	  bool _tainted;
 	  double _totalQueueTime;
 	  double _totalPrice;
+	  // exact sum of the queue times of the untainted queues
+	  scheduler::JobQueue::TimeSumType _queueTimeSum;
+	  // exact running sum of the job prices, see PriceTable
+	  scheduler::PriceTable::SumType _priceSum;
   };
 
 }
@@ -5,192 +5,236 @@
 #include <cmath>
 #include <taintedstateexception.hpp>
 #include <random.hpp>
+#include <telemetry.hpp>
 
 
 using namespace scheduler;
 
 
+const double ScheduleArchive::AREA_SCALE = 65536.0;
+
 void ScheduleArchive::addSchedule(const scheduler::Schedule::Ptr schedule) {
-  _archive->push_back(schedule);
+  FrontType::iterator it=_archive.insert(FrontType::value_type(getKey(schedule), schedule)).first;
+  FrontType::iterator next=it;
+  ++next;
+  if (it != _archive.begin()) {
+	FrontType::iterator prev=it;
+	--prev;
+	_area += getArea((*prev).first, (*it).first);
+	if (next != _archive.end())
+	  _area -= getArea((*prev).first, (*next).first);
+  }
+  if (next != _archive.end())
+	_area += getArea((*it).first, (*next).first);
   _tainted=true;
 }
 
-bool ScheduleArchive::archiveSchedule(const scheduler::Schedule::Ptr schedule) {
-  bool retval=false;
-  bool foundDominated=false;
-  // Check if the new schedule is a duplicate - ignore it.
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	if ((*it)->equals(schedule)) {
-	  //std::cout << "*** Attempt to add duplicate schedule to archive, ignoring " << schedule->str() << std::endl;
-	  return false;
+void ScheduleArchive::removeSchedule(const FrontType::iterator& it) {
+  FrontType::iterator next=it;
+  ++next;
+  if (next != _archive.end())
+	_area -= getArea((*it).first, (*next).first);
+  if (it != _archive.begin()) {
+	FrontType::iterator prev=it;
+	--prev;
+	_area -= getArea((*prev).first, (*it).first);
+	if (next != _archive.end())
+	  _area += getArea((*prev).first, (*next).first);
+  }
+  _archive.erase(it);
+  _tainted=true;
+}
+
+ScheduleArchive::AreaType ScheduleArchive::getArea(const KeyType& left, const KeyType& right) {
+  double deltaPrice=fabs(left.second - right.second);
+  double deltaQT=fabs(right.first - left.first);
+  double area=(deltaQT * right.second) + (deltaQT * (deltaPrice/2));
+  return (AreaType) (area * AREA_SCALE + 0.5);
+}
+
+ScheduleArchive::KeyType ScheduleArchive::getKey(const scheduler::Schedule::Ptr& schedule) {
+  return KeyType(schedule->getTotalQueueTime(), schedule->getTotalPrice());
+}
+
+bool ScheduleArchive::isPointDominated(const KeyType& key) {
+  // last schedule with a smaller queue time
+  FrontType::iterator it=_archive.lower_bound(KeyType(key.first, -HUGE_VAL));
+  if (it == _archive.begin())
+	return false;
+  --it;
+  // The cheapest schedule with a smaller queue time is the first one
+  // with this queue time.
+  FrontType::iterator cheapest=_archive.lower_bound(KeyType((*it).first.first, -HUGE_VAL));
+  return (*cheapest).first.second < key.second;
+}
+
+size_t ScheduleArchive::removeDominatedBy(const KeyType& key) {
+  size_t removed=0;
+  FrontType::iterator it=_archive.upper_bound(KeyType(key.first, HUGE_VAL));
+  while (it != _archive.end()) {
+	if ((*it).first.second > key.second) {
+	  _removed.push_back((*it).second);
+	  removeSchedule(it++);
+	  removed++;
+	  continue;
+	}
+	// Larger queue times are not more expensive than this schedule, so
+	// only the rest of its queue time can still be dominated.
+	double groupQueueTime=(*it).first.first;
+	++it;
+	while (it != _archive.end() && (*it).first.first == groupQueueTime) {
+	  if ((*it).first.second > key.second) {
+		_removed.push_back((*it).second);
+		removeSchedule(it++);
+		removed++;
+	  } else
+		++it;
 	}
+	break;
+  }
+  if (removed > 0)
+	_tainted=true;
+  return removed;
+}
+
+bool ScheduleArchive::archiveSchedule(const scheduler::Schedule::Ptr schedule) {
+  TELEMETRY_TIMER(ARCHIVE);
+  KeyType key=getKey(schedule);
+  // Check if the new schedule is a duplicate or dominated - ignore it.
+  // A single search path never passes dominated schedules, but other
+  // threads may have archived better ones meanwhile.
+  if (_archive.find(key) != _archive.end() || isPointDominated(key)) {
+	TELEMETRY_COUNT(ARCHIVE_REJECT);
+	return false;
+  }
+  if (_archive.empty()) { // If archive is empty: add and exit.
+	TELEMETRY_COUNT(ARCHIVE_INSERT);
+	addSchedule(schedule);
+	updateGrid(schedule);
+	return false;
   }
-  if (_archive->size() == 0) { // If archive is empty: add and exit.
+  // Check if the new solution dominates any of the archived solutions.
+  if (removeDominatedBy(key) > 0) {
+	// The new schedule dominated at least one solution - add it to the archive.
+	TELEMETRY_COUNT(ARCHIVE_INSERT);
 	addSchedule(schedule);
+	updateGrid(schedule);
+	return true;
+  }
+  // The current schedule is non-dominated by the list, but doesn't dominate other schedules.
+  if (_archive.size() >= _maxSize) {
+	// Replace a solution from the most crowded grid location.
+	if (_gridStale)
+	  updateAllLocations();
+	scheduler::Schedule::Ptr replace=_grid.getRandomCrowdedSchedule();
+	assert(replace);
+	removeSchedule(_archive.find(getKey(replace)));
+	_removed.push_back(replace);
+	_tainted=true;
+	TELEMETRY_COUNT(ARCHIVE_REPLACE);
   } else {
-	//std::cout << "*** Assessing schedule." << std::endl;
-	// Check if the new solution dominates any of the archived solutions.
-	std::vector<scheduler::Schedule::Ptr>* newArchive=new std::vector<scheduler::Schedule::Ptr>();
-	std::vector<scheduler::Schedule::Ptr>::iterator it;
-	for(  it = _archive->begin(); it < _archive->end(); it++) {
-	  if (schedule->dominates((*it))) {
-		//std::cout << "*** Found dominated schedule: " << (*it)->str() << std::endl;
-		foundDominated=true;
-	  } else {
-		newArchive->push_back((*it));
-	  }
-	}
-	if (foundDominated) {
-	  //std::cout << "*** Swapping the archives." << std::endl;
-	  // Swap the vectors.
-	  delete(_archive);
-	  _archive=newArchive;
-	  // The new schedule dominated at least one solution - add it to the archive.
-	  addSchedule(schedule);
-	} else {
-	  // no archived solution was dominated by the new one - free memory.
-	  //std::cout << "*** No archived solution was dominated by the new one." << std::endl;
-	  delete(newArchive);
-	  // The current schedule is non-dominated by the list, but doesn't dominate other schedules.
-	  if (_archive->size() < _maxSize) {
-		// There's still space left, store this one.
-		addSchedule(schedule);
-	  } else {
-		// Compare locations & replace a solution from the most crowded space.
-		//std::cout << "*** Using location pressure to replace an existing solution." << std::endl;
-		unsigned long maxPopulation=getMaxPopulationCount();
-		std::vector<unsigned long> removeCandidates;
-		retval=true;
-		std::vector<scheduler::Schedule::Ptr>::iterator it;
-		unsigned long currentIndex = 0;
-		for(  it = _archive->begin(); it != _archive->end(); it++) {
-		  scheduler::Schedule::LocationType location=(*it)->getLocation();
-		  unsigned long population=getPopulationCount(location);
-		  if (population == maxPopulation)
-			removeCandidates.push_back(currentIndex);
-		  ++currentIndex;
-		}
-		// Select a schedule to replace
-		util::RNG& rng=util::RNG::instance();
-		unsigned long replaceIndex=rng.uniform_derivate_ranged_int(0, removeCandidates.size()-1);
-		assert(replaceIndex < removeCandidates.size());
-		//std::cout << "Replacing candidate no. " << removeCandidates[replaceIndex] << std::endl;
-		_archive->erase(_archive->begin() + removeCandidates[replaceIndex]);
-		//for(it = _archive->begin(); it != _archive->end();) {
-		//  scheduler::Schedule::LocationType location=(*it)->getLocation();
-		//  unsigned long population=getPopulationCount(location);
-		//  if (population == maxPopulation) {
-		//	it = _archive->erase(it);
-		//	break;
-		//  } else
-		//	++it;
-		//}
+	TELEMETRY_COUNT(ARCHIVE_INSERT);
+  }
+  addSchedule(schedule);
+  updateGrid(schedule);
+  return false;
+}
 
-		//std::cout << "*** replacing " << (*replace)->str() << ", max population: " << maxPopulation << std::endl;
-		//_archive->erase(replace);
-		addSchedule(schedule);
+void ScheduleArchive::updateGrid(const scheduler::Schedule::Ptr& added) {
+  TELEMETRY_TIMER(LOCATION);
+  updateMinMaxValues();
+  if (! _gridStale) {
+	if (_grid.setBounds(_minQueueTime, _maxQueueTime, _minPrice, _maxPrice)) {
+	  // all locations move
+	  if (_batch)
+		_gridStale=true;
+	  else
+		updateAllLocations();
+	} else {
+	  std::vector<scheduler::Schedule::Ptr>::iterator it;
+	  for(  it = _removed.begin(); it != _removed.end(); it++) {
+		_grid.remove(*it);
 	  }
+	  _grid.add(added);
 	}
   }
-  //return retval;
-  return foundDominated;
+  _removed.clear();
 }
 
-unsigned long ScheduleArchive::getMaxPopulationCount() {
-  unsigned long maxPopulation=0;
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	scheduler::Schedule::LocationType location=(*it)->getLocation();
-	unsigned long population=getPopulationCount(location);
-	if (population > maxPopulation) {
-	  maxPopulation = population;
-	}
+std::vector<scheduler::Schedule::Ptr> ScheduleArchive::getSortedSchedules() {
+  std::vector<scheduler::Schedule::Ptr> retval;
+  retval.reserve(_archive.size());
+  FrontType::iterator it;
+  for(  it = _archive.begin(); it != _archive.end(); it++) {
+	retval.push_back((*it).second);
   }
-  return maxPopulation;
+  return retval;
 }
 
-bool sortSchedulePredicate(const scheduler::Schedule::Ptr a, const scheduler::Schedule::Ptr b) {
-  if ((a->getTotalQueueTime()) < (b->getTotalQueueTime())) {
-	return true;
-  } else if ((a->getTotalQueueTime()) == (b->getTotalQueueTime())) {
-	return ((a->getTotalPrice()) < (b->getTotalPrice()));
-  } else {
-	return false;
-  }
+const scheduler::AdaptiveGrid::LayoutType ScheduleArchive::getGridLayout() const {
+  assert(! _gridStale);
+  return _grid.getLayout();
 }
 
-const double ScheduleArchive::getDistance() {
-  double total_area=0.0;
-  double prev_price=getMinPrice();
-  double prev_qt=getMinQueueTime();
-  std::sort(_archive->begin(), _archive->end(), sortSchedulePredicate);
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	double deltaPrice=fabs(prev_price - (*it)->getTotalPrice());
-	double deltaQT= fabs(((*it)->getTotalQueueTime() - prev_qt));
-	total_area += ((deltaQT * (*it)->getTotalPrice()) + (deltaQT * (deltaPrice/2)));
-	prev_qt=(*it)->getTotalQueueTime();
-	prev_price=(*it)->getTotalPrice();
+void ScheduleArchive::restore(const std::vector<scheduler::Schedule::Ptr>& schedules,
+	const scheduler::AdaptiveGrid::LayoutType& layout) {
+  _archive.clear();
+  _area=0;
+  _removed.clear();
+  std::vector<scheduler::Schedule::Ptr>::const_iterator it;
+  for(  it = schedules.begin(); it != schedules.end(); it++) {
+	addSchedule(*it);
   }
-  return total_area;
+  _gridStale=false;
+  updateMinMaxValues();
+  _grid.setBounds(_minQueueTime, _maxQueueTime, _minPrice, _maxPrice);
+  _grid.setLayout(layout);
 }
 
 const std::string ScheduleArchive::getRelLogLines() {
-  std::sort(_archive->begin(), _archive->end(), sortSchedulePredicate);
   std::ostringstream oss;
   oss << "QT\tPrice" << std::endl;
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	oss << ((*it)->getTotalQueueTime()/_workload_size) << "\t";
-	oss << ((*it)->getTotalPrice()/_workload_size) << std::endl;
+  FrontType::iterator it;
+  for(  it = _archive.begin(); it != _archive.end(); it++) {
+	oss << ((*it).second->getTotalQueueTime()/_workload_size) << "\t";
+	oss << ((*it).second->getTotalPrice()/_workload_size) << std::endl;
   }
   return oss.str();
 }
 
 const std::string ScheduleArchive::getAbsLogLines() {
-  std::sort(_archive->begin(), _archive->end(), sortSchedulePredicate);
   std::ostringstream oss;
   oss << "QT\tPrice" << std::endl;
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	oss << (*it)->getTotalQueueTime() << "\t";
-	oss << (*it)->getTotalPrice() << std::endl;
+  FrontType::iterator it;
+  for(  it = _archive.begin(); it != _archive.end(); it++) {
+	oss << (*it).second->getTotalQueueTime() << "\t";
+	oss << (*it).second->getTotalPrice() << std::endl;
   }
   return oss.str();
 }
 
 bool ScheduleArchive::dominates(const scheduler::Schedule::Ptr& schedule) {
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	if ((*it)->compare(schedule) == scheduler::Schedule::DOMINATES)
-	  return true;
-  }
-  return false;
+  return isPointDominated(getKey(schedule));
 }
 
 bool ScheduleArchive::isDominated(const scheduler::Schedule::Ptr& schedule) {
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(it = _archive->begin(); it < _archive->end(); it++) {
-	if ((*it)->dominates(schedule))
-	  return false;
-  }
-  return true;
+  return ! isPointDominated(getKey(schedule));
 }
 
 void ScheduleArchive::updateMinMaxValues () {
   if (_tainted) {
-	_maxQueueTime = _maxPrice = 0.0;
-	_minQueueTime = _minPrice = DBL_MAX;
-	std::vector<scheduler::Schedule::Ptr>::iterator it;
-	for(  it = _archive->begin(); it < _archive->end(); it++) {
-	  // Do comparisons.
-	  double qt=(*it)->getTotalQueueTime();
-	  double p=(*it)->getTotalPrice();
-	  if (qt > _maxQueueTime) _maxQueueTime = qt;
-	  if (qt < _minQueueTime) _minQueueTime = qt;
-	  if (p > _maxPrice) _maxPrice = p;
-	  if (p < _minPrice) _minPrice = p;
+	if (_archive.empty()) {
+	  _maxQueueTime = _maxPrice = 0.0;
+	  _minQueueTime = _minPrice = DBL_MAX;
+	} else {
+	  _minQueueTime = (*_archive.begin()).first.first;
+	  _maxQueueTime = (*_archive.rbegin()).first.first;
+	  // The most expensive schedule has the smallest queue time, the
+	  // cheapest one the largest.
+	  FrontType::iterator it=_archive.upper_bound(KeyType(_minQueueTime, HUGE_VAL));
+	  --it;
+	  _maxPrice = (*it).first.second;
+	  _minPrice = (*_archive.lower_bound(KeyType(_maxQueueTime, -HUGE_VAL))).first.second;
 	}
 	_tainted=false;
   }
@@ -221,67 +265,43 @@ void ScheduleArchive::updateMinMaxValues () {
 	return _minPrice;
   }
 
-scheduler::Schedule::LocationDimensionType ScheduleArchive::calculateLocation(
-	const double& current, const double& min, const double& max) {
-  if ((current < min) || (current > max)) 
-	throw TaintedStateException("Tainted: current value is not in the [min; max]-Interval.");
-  double lBound = min;
-  double uBound = max;
-  scheduler::Schedule::LocationDimensionType location;
-  for( unsigned int i = 0; i < config::LOCATION_DIMENSION_SIZE; i += 1) {
-	location <<= 1;
-	double center=lBound + ((uBound - lBound) / 2.0);
-	//	std::cout << "current=" << current <<", lBound=" << lBound << ", center=" << center <<", uBound=" << uBound;
-	if (current >= center) {
-	  location[0]=1;
-	  lBound=center;
-	} else {
-	  location[0]=0;
-	  uBound=center;
-	}
-	//	std::cout << ", location=" << location << std::endl;
-  }
-  return location;
+void ScheduleArchive::beginBatch() {
+  _batch=true;
 }
 
-scheduler::Schedule::LocationType ScheduleArchive::encodeDimensions(
-	const scheduler::Schedule::LocationDimensionType& priceDimension,
-	const scheduler::Schedule::LocationDimensionType& queueTimeDimension) {
-  std::string foo = priceDimension.to_string();
-  std::string bar = queueTimeDimension.to_string();
-  std::string retval( foo + bar);
-  //std::cout << "price: "<<priceDimension << " qt: " << queueTimeDimension << " => combined: " << retval << std::endl; 
-  return scheduler::Schedule::LocationType(retval);
+void ScheduleArchive::endBatch() {
+  _batch=false;
+  if (_gridStale)
+	updateAllLocations();
 }
 
-
 void ScheduleArchive::updateAllLocations() {
-  //std::cout << "Updating the location of all schedules." << std::endl;
-  _population.clear();
-  std::vector<scheduler::Schedule::Ptr>::iterator it;
-  for(  it = _archive->begin(); it < _archive->end(); it++) {
-	double qt=(*it)->getTotalQueueTime();
-	double p=(*it)->getTotalPrice();
-	scheduler::Schedule::LocationDimensionType pDimension=calculateLocation(p, getMinPrice(), getMaxPrice());
-	scheduler::Schedule::LocationDimensionType qtDimension=calculateLocation(qt, getMinQueueTime(), getMaxQueueTime());
-	scheduler::Schedule::LocationType location=encodeDimensions(pDimension, qtDimension);
-	(*it)->setLocation(location);
-	std::string sLocation=location.to_string();
-	_population[sLocation] = _population[sLocation] + 1;
+  TELEMETRY_TIMER(LOCATION);
+  _gridStale=false;
+  updateMinMaxValues();
+  _grid.setBounds(_minQueueTime, _maxQueueTime, _minPrice, _maxPrice);
+  _grid.clear();
+  FrontType::iterator it;
+  for(  it = _archive.begin(); it != _archive.end(); it++) {
+	_grid.add((*it).second);
   }
 }
 
 std::string ScheduleArchive::getPopulationStr() {
-  std::ostringstream oss;
-  oss << "location -> count" << std::endl;
-  std::map<std::string, unsigned long>::iterator it;
-  for ( it=_population.begin() ; it != _population.end(); it++ )
-	oss << (*it).first << " -> " << (*it).second << std::endl;
-  return oss.str();
+  if (_gridStale)
+	updateAllLocations();
+  return _grid.str();
 }
 
-const unsigned long ScheduleArchive::getPopulationCount(scheduler::Schedule::LocationType location) {
-  return _population[location.to_string()];
+unsigned long ScheduleArchive::getPopulationCount(const scheduler::Schedule::Ptr& schedule) {
+  if (_gridStale)
+	updateAllLocations();
+  updateMinMaxValues();
+  KeyType key=getKey(schedule);
+  if (key.first < _minQueueTime || key.first > _maxQueueTime ||
+	  key.second < _minPrice || key.second > _maxPrice)
+	return 0;
+  return _grid.getPopulation(_grid.locate(key.first, key.second));
 }
 
 //const std::string ScheduleArchive::str() {
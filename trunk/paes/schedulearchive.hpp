@@ -3,38 +3,94 @@
 
 #include <common.hpp>
 #include <schedule.hpp>
+#include <adaptivegrid.hpp>
+#include <mutex.hpp>
 #include <vector>
+#include <map>
+#include <utility>
 
 namespace scheduler {
+  /**
+   * The archive keeps the non-dominated schedules ordered by queue time
+   * and price. As dominance is strict in both objectives, the prices
+   * never increase from one queue time to the next, so dominance
+   * checks, duplicate checks and inserting a schedule (removing the k
+   * schedules it dominates) take O(log n + k). The crowding grid is
+   * kept up to date on every change, see AdaptiveGrid.
+   *
+   * The archive is not synchronized internally. If several threads
+   * share it, they must hold the lock returned by getMutex() while
+   * calling any of its methods.
+   */
   class ScheduleArchive {
 	public:
 	  typedef std::tr1::shared_ptr<ScheduleArchive> Ptr;
-	  ScheduleArchive(const size_t size, const size_t workload_size) : 
-		_maxQueueTime(0.0), _minQueueTime(0.0),
+	  /**
+	   * (queue time, price) of a schedule.
+	   */
+	  typedef std::pair<double, double> KeyType;
+	  typedef std::map<KeyType, scheduler::Schedule::Ptr> FrontType;
+	  /**
+	   * Fixed point area, in units of 1/AREA_SCALE. The sum of the
+	   * rounded trapezoids is exact, so it does not depend on the order
+	   * of insertions and removals.
+	   */
+	  typedef __int128 AreaType;
+	  static const double AREA_SCALE;
+	  ScheduleArchive(const size_t size, const size_t workload_size,
+		  const unsigned int locationBits = config::LOCATION_DIMENSION_SIZE) : 
+		_archive(), _maxQueueTime(0.0), _minQueueTime(0.0),
 		_maxPrice(0.0), _minPrice(0.0), _tainted(true), _maxSize(size), 
-		_workload_size(workload_size), _population() {
-		_archive=new std::vector<scheduler::Schedule::Ptr>;
-	  };
-	  virtual ~ScheduleArchive() {
-		delete(_archive);
-	  };
+		_workload_size(workload_size), _grid(locationBits), _removed(),
+		_batch(false), _gridStale(false), _area(0), _mutex() { };
+	  virtual ~ScheduleArchive() { };
 	  /**
 	   * returns true if the schedule dominated to the archive,
+	   * schedules dominated by an archived one are rejected.
 	   */
 	  bool archiveSchedule(const scheduler::Schedule::Ptr schedule);
+	  /**
+	   * Between beginBatch() and endBatch(), a move of the bounds does
+	   * not rebuild the grid at once. The grid is rebuilt when it is
+	   * needed next, at the latest by endBatch().
+	   */
+	  void beginBatch();
+	  void endBatch();
+	  /**
+	   * Returns the archived schedules, sorted by queue time and price.
+	   */
+	  std::vector<scheduler::Schedule::Ptr> getSortedSchedules();
+	  /**
+	   * Returns the grid as it is, see AdaptiveGrid::getLayout(). Must
+	   * not be called within a batch.
+	   */
+	  const scheduler::AdaptiveGrid::LayoutType getGridLayout() const;
+	  /**
+	   * Replaces the archived schedules and the grid, e.g. by the ones of
+	   * a checkpoint. The schedules must not dominate each other, the
+	   * layout must hold exactly these schedules.
+	   */
+	  void restore(const std::vector<scheduler::Schedule::Ptr>& schedules,
+		  const scheduler::AdaptiveGrid::LayoutType& layout);
 	  const std::string getRelLogLines();
 	  const std::string getAbsLogLines();
 //	  const std::string str();
-	  const size_t size() { return _archive->size(); };
+	  size_t size() { return _archive.size(); };
 	  const double getMaxQueueTime();
 	  const double getMaxPrice();
 	  const double getMinQueueTime();
 	  const double getMinPrice();
 	  /**
 	   * Returns the distance of the Pareto front to the coordinate
-	   * system.
+	   * system: the area below the front, summed up from the trapezoids
+	   * between neighbouring schedules. It is kept up to date on every
+	   * change, so reading it is O(1).
+	   */
+	  double getDistance() const { return _area / AREA_SCALE; };
+	  /**
+	   * Recomputes the grid locations of all archived schedules. The
+	   * archive does this itself whenever its bounds change.
 	   */
-	  const double getDistance();
 	  void updateAllLocations();
 	  /**
 	   * Returns true if at least one schedule in the archive dominates
@@ -46,20 +102,44 @@ namespace scheduler {
 	   */
 	  bool isDominated(const scheduler::Schedule::Ptr& schedule);
 	  std::string getPopulationStr();
-	  const unsigned long getPopulationCount(scheduler::Schedule::LocationType location);
+	  /**
+	   * Returns the number of archived schedules in the grid cell of the
+	   * schedule, which need not be archived itself. The cell is
+	   * computed from the current bounds, so stored locations never
+	   * matter. A schedule outside the bounds is in no cell, 0.
+	   */
+	  unsigned long getPopulationCount(const scheduler::Schedule::Ptr& schedule);
+	  util::Mutex& getMutex() { return _mutex; };
 
 	private:
 	  void updateMinMaxValues ();
 	  void addSchedule(const scheduler::Schedule::Ptr schedule);
-	  unsigned long getMaxPopulationCount();
-	  scheduler::Schedule::LocationType encodeDimensions(
-		  const scheduler::Schedule::LocationDimensionType& priceDimension,
-		  const scheduler::Schedule::LocationDimensionType& queueTimeDimension);
-	  scheduler::Schedule::LocationDimensionType calculateLocation(
-		  const double& current, const double& min, const double& max);
+	  /**
+	   * Erases the schedule from the front, but not from the grid.
+	   */
+	  void removeSchedule(const FrontType::iterator& it);
+	  /**
+	   * The area of the trapezoid between two neighbouring schedules.
+	   */
+	  static AreaType getArea(const KeyType& left, const KeyType& right);
+	  static KeyType getKey(const scheduler::Schedule::Ptr& schedule);
+	  /**
+	   * Returns true if an archived schedule dominates the point.
+	   */
+	  bool isPointDominated(const KeyType& key);
+	  /**
+	   * Removes all archived schedules dominated by the point, returns
+	   * the number of removed schedules.
+	   */
+	  size_t removeDominatedBy(const KeyType& key);
+	  /**
+	   * Moves the schedules removed by the last change out of the grid
+	   * and the added one in, or rebuilds the grid if the bounds moved.
+	   */
+	  void updateGrid(const scheduler::Schedule::Ptr& added);
 	  ScheduleArchive (const ScheduleArchive& original);
 	  ScheduleArchive& operator= (const ScheduleArchive& rhs);
-	  std::vector<scheduler::Schedule::Ptr>* _archive;
+	  FrontType _archive;
 	  double _maxQueueTime;
 	  double _minQueueTime;
 	  double _maxPrice;
@@ -67,7 +147,12 @@ namespace scheduler {
 	  bool _tainted;
 	  size_t _maxSize;
 	  size_t _workload_size;
-	  std::map<std::string, unsigned long> _population;
+	  scheduler::AdaptiveGrid _grid;
+	  std::vector<scheduler::Schedule::Ptr> _removed;
+	  bool _batch;
+	  bool _gridStale;
+	  AreaType _area;
+	  util::Mutex _mutex;
   };
 }
 
@@ -1,88 +1,62 @@
 #include "simpleresource.hpp"
 #include <sstream>
-#include <taintedstateexception.hpp>
 
 using namespace scheduler;
 
-SimpleResource::SimpleResource (const SimpleResource& original) : 
-  Resource (original), 
-  _jobs(original._jobs), 
-  _allocations(original._allocations)
-{ }
-
 const std::string SimpleResource::str() {
   std::ostringstream oss;
-  oss << "# Simple resource " << getResourceName() << "(id: " << getResourceID() << ")";
-  oss << ", " << _jobs.size() << " jobs";
-  oss << " total QT: " << _totalQueueTime << ", total price: " << _totalPrice;
-  if (_tainted)
-	oss << ", tainted, ";
-  else
-	oss << ", not tainted, ";
+  oss << "# Simple resource " << getResourceName() << "(id: " << getResourceID() << "), ";
   oss << _pricingPlan->str();
   return oss.str();
 }
 
-void SimpleResource::addJob(const scheduler::Job::Ptr& job) {
-  Job::IDType currentID(job->getJobID());
-  _jobs[currentID]=job;
-  _tainted=true;
-}
-
-void SimpleResource::removeAllJobs() {
-  _jobs.clear();
-  clear();
-}
-
-void SimpleResource::clear() {
-  _allocations.clear();
-  _totalQueueTime = _totalPrice = 0.0;
-  _tainted=false;
-}
-
-//TODO: The schedule can be built more efficiently during addJob.
-void SimpleResource::reSchedule() {
+void SimpleResource::reSchedule(const scheduler::Workload::Ptr& workload,
+	scheduler::JobQueue& queue) const {
   //std::cout << "Rescheduling " << getResourceName() << std::endl;
-  // The jobs are sorted by the map, so we get increasing job ids automatically.
-  double freetime=0.0;
-  _totalQueueTime = _totalPrice = 0.0;
+  // The job indices are sorted, so we get increasing job ids automatically.
+  // A job's start time depends only on the finish time of the job before
+  // it, so the jobs before the first change keep their times.
+  const scheduler::Workload& jobs=*workload;
+  const JobQueue::JobListType& queuedJobs=queue.getJobs();
+  const JobQueue::TimeListType& startTimes=queue.getStartTimes();
+  size_t first=queue.getFirstChanged();
+  size_t unchanged=queue.getChangedEnd();
+  double freetime=(first > 0) ? queue.getFinishTimes()[first - 1] : 0.0;
   // 2. Calculate the allocation times
-  std::map<scheduler::Job::IDType, scheduler::Job::Ptr>::iterator it;
-  for (it=_jobs.begin(); it != _jobs.end(); it++) {
-	Job::Ptr current=(*it).second;
-	Job::IDType currentID(current->getJobID());
-	double starttime, queuetime, finishtime, price= 0.0;
-	if (freetime < current->getSubmitTime()) {
+  for (size_t i=first; i < queuedJobs.size(); i++) {
+	Workload::IndexType current=queuedJobs[i];
+	double submittime=jobs.getSubmitTime(current);
+	double starttime, queuetime, finishtime;
+	if (freetime < submittime) {
 	  // the job can run instantly.
-	  starttime=current->getSubmitTime();
+	  starttime=submittime;
 	} else { // (freetime >= job.submitTime)
 	  // The job must wait for the resource to become available.
 	  starttime = freetime;
 	}
-	queuetime = starttime - current->getSubmitTime();
-	_totalQueueTime += queuetime;
-	finishtime = starttime + current->getRunTime();
-	price=_pricingPlan->getPrice(current);
-	_totalPrice += price;
-	freetime=starttime + current->getRunTime();
-	// Create a new allocation for this job
-	Allocation::Ptr allocation(new Allocation(current->getJobID(), starttime, queuetime, finishtime, price));
-	//std::cout << "generated "<< allocation->str() << std::endl;
-	_allocations[currentID]=allocation;
+	// An unchanged job that starts at the same time as before finishes
+	// at the same time as well, and so do all jobs after it.
+	if (i >= unchanged && starttime == startTimes[i])
+	  break;
+	queuetime = starttime - submittime;
+	finishtime = starttime + jobs.getRunTime(current);
+	freetime=finishtime;
+	queue.setTimes(i, starttime, queuetime, finishtime);
   }
-  _tainted=false;
+  queue.setEvaluated();
 }
 
-bool SimpleResource::sanityCheck() {
+bool SimpleResource::sanityCheck(const scheduler::Workload::Ptr& workload,
+	scheduler::JobQueue& queue) const {
     bool success=true;
-    if (_allocations.size() >= 2) {
-	  std::map<scheduler::Job::IDType, scheduler::Allocation::Ptr>::iterator it;
-	  it=_allocations.begin();
-	  scheduler::Allocation::Ptr precursor=(*it).second;
-	  for (it=(++it); it != _allocations.end(); it++) {
-		scheduler::Allocation::Ptr current=(*it).second;
+    const JobQueue::JobListType& queuedJobs=queue.getJobs();
+    AllocationListType allocations=getAllocations(workload, queue);
+    if (allocations.size() >= 2) {
+	  scheduler::Allocation::Ptr precursor=allocations[0];
+	  for (size_t i=1; i < allocations.size(); i++) {
+		scheduler::Allocation::Ptr current=allocations[i];
 		//std::cout << "Precursor: " << precursor->str() << ", current " << current->str() << std::endl;
-		if (current->getStartTime() < _jobs[(*it).first]->getSubmitTime()) {
+		if (current->getStartTime() < workload->getSubmitTime(queuedJobs[i])) {
 		  std::cout << "Start time before submit time!" << std::endl;
 		  std::cout << "Precursor: " << precursor->str() << ", current " << current->str() << std::endl;
 		  success=false;
@@ -92,7 +66,7 @@ bool SimpleResource::sanityCheck() {
 		  std::cout << "Precursor: " << precursor->str() << ", current " << current->str() << std::endl;
 		  success=false;
 		}
-		if (_jobs[(*it).first]->getSubmitTime() < _jobs[precursor->getJobID()]->getSubmitTime()) {
+		if (workload->getSubmitTime(queuedJobs[i]) < workload->getSubmitTime(queuedJobs[i-1])) {
 		  std::cout << "submit time before previous submit time!" << std::endl;
 		  std::cout << "Precursor: " << precursor->str() << ", current " << current->str() << std::endl;
 		  success=false;
@@ -106,17 +80,3 @@ bool SimpleResource::sanityCheck() {
 	  std::cout << "Simple Resource "<< getResourceName() << ": Sanity FAIL" << std::endl;
 	return success;
 }
-
-const double SimpleResource::getTotalQueueTime() {
-  if (! _tainted)
-	return _totalQueueTime;
-  else
-	throw TaintedStateException("Tainted: No up-to-date total QT available.");
-}
-
-const double SimpleResource::getTotalPrice() {
-  if (! _tainted)
-	return _totalPrice;
-  else
-	throw TaintedStateException("Tainted: No up-to-date total price available.");
-}
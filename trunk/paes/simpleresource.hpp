@@ -4,35 +4,31 @@
 #include <common.hpp>
 #include <workload.hpp>
 #include <resource.hpp>
-#include <job.hpp>
-#include <allocation.hpp>
+#include <jobqueue.hpp>
 
 namespace scheduler {
+  /**
+   * A single FCFS queue: jobs run one after another in job id order.
+   */
   class SimpleResource : public scheduler::Resource {
 	public:
 	  typedef std::tr1::shared_ptr<SimpleResource> Ptr;
 	  typedef unsigned int IDType;
 	  SimpleResource (IDType resourceID, const std::string& resourceName, scheduler::PricingPlan::Ptr pricingPlan): 
-			Resource (resourceID, resourceName, pricingPlan), _jobs(), _allocations() {};
-	  SimpleResource (const SimpleResource& original);
+			Resource (resourceID, resourceName, pricingPlan) {};
 	  virtual ~SimpleResource() {};
 
 	  const std::string str();
-	  void addJob(const scheduler::Job::Ptr& job);
-	  void removeAllJobs();
-	  void reSchedule();
-	  bool sanityCheck();
-	  void clear();
-
-	  const double getTotalQueueTime();
-	  const double getTotalPrice(); 
+	  void reSchedule(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const;
+	  bool sanityCheck(const scheduler::Workload::Ptr& workload,
+		  scheduler::JobQueue& queue) const;
+	  bool isFCFS() const { return true; };
 
 	private:
+	  SimpleResource (const SimpleResource& original);
 	  SimpleResource& operator= (const SimpleResource& rhs);
-	  std::map<scheduler::Job::IDType, scheduler::Job::Ptr> _jobs;
-	  std::map<scheduler::Job::IDType, scheduler::Allocation::Ptr> _allocations;
   };
 }
 
 #endif /* PAES_SIMPLERESOURCE_HPP */
-
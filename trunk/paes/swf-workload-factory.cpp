@@ -0,0 +1,68 @@
+#include "swf-workload-factory.hpp"
+#include <mappedfile.hpp>
+#include <numberscanner.hpp>
+#include <stdexcept>
+#include <string.h>
+
+using namespace scheduler;
+
+namespace {
+  const unsigned int SWF_FIELDS = 18;
+  // field numbers as in the SWF definition, counting from 1
+  const unsigned int JOB_NUMBER = 1;
+  const unsigned int SUBMIT_TIME = 2;
+  const unsigned int RUN_TIME = 4;
+  const unsigned int ALLOCATED_PROCESSORS = 5;
+  const unsigned int REQUESTED_PROCESSORS = 8;
+  const unsigned int REQUESTED_TIME = 9;
+}
+
+scheduler::Workload::Ptr SWFWorkloadFactory::parseWorkload() {
+  scheduler::Workload::Ptr retval(new scheduler::Workload());
+  std::cout << "Loading SWF workload from file " << _filename << std::endl;
+  util::MappedFile::Ptr file;
+  try {
+	file=util::MappedFile::Ptr(new util::MappedFile(_filename));
+  } catch (std::runtime_error& e) {
+	std::cerr << e.what() << ", aborting" << std::endl; 
+	exit(-1);
+  }
+  const char* pos=file->begin();
+  const char* end=file->end();
+  unsigned long lineNumber=0;
+  unsigned long skipped=0;
+  double fields[SWF_FIELDS + 1];
+  while (pos < end) {
+	lineNumber++;
+	const char* eol=static_cast<const char*>(memchr(pos, '\n', end - pos));
+	if (eol == NULL)
+	  eol=end;
+	const char* p=util::scanner::skipBlanks(pos, eol);
+	// ignore empty lines and the ';' header comments
+	if (p != eol && *p != ';') {
+	  unsigned int count=0;
+	  while (count < SWF_FIELDS && util::scanner::scanDouble(p, eol, fields[count + 1]))
+		count++;
+	  if (count < REQUESTED_TIME || fields[JOB_NUMBER] < 0) {
+		std::cerr << _filename << ":" << lineNumber << ": malformed SWF line - aborting." << std::endl;
+		exit(-1);
+	  }
+	  if (fields[RUN_TIME] < 0) {
+		skipped++;
+	  } else {
+		double wall_time = fields[REQUESTED_TIME] >= 0 ? fields[REQUESTED_TIME] : fields[RUN_TIME];
+		double size = fields[ALLOCATED_PROCESSORS];
+		if (size <= 0)
+		  size = fields[REQUESTED_PROCESSORS];
+		if (size <= 0)
+		  size = 1;
+		retval->add((scheduler::Job::IDType) fields[JOB_NUMBER], fields[SUBMIT_TIME],
+			fields[RUN_TIME], wall_time, (unsigned int) size);
+	  }
+	}
+	pos=eol + 1;
+  }
+  if (skipped > 0)
+	std::cout << "Skipped " << skipped << " jobs without run time." << std::endl;
+  return retval;
+}
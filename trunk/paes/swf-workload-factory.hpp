@@ -0,0 +1,31 @@
+#ifndef PAES_SWF_WORKLOAD_FACTORY_HPP
+#define PAES_SWF_WORKLOAD_FACTORY_HPP 1
+
+#include <common.hpp>
+#include <workload.hpp>
+
+namespace scheduler {
+  /**
+   * Reads a trace in the Standard Workload Format of the Parallel
+   * Workloads Archive. The job id is field 1, the submit time field 2,
+   * the run time field 4, the wall time the requested time (field 9)
+   * and the size the allocated processors (field 5). Jobs without a
+   * run time are skipped, a missing requested time is replaced by the
+   * run time and a missing size by the requested processors (field 8).
+   */
+  class SWFWorkloadFactory {
+	public:
+	  typedef std::tr1::shared_ptr<SWFWorkloadFactory> Ptr;
+	  SWFWorkloadFactory (const std::string& filename) :
+		_filename(filename) {};
+	  virtual ~SWFWorkloadFactory() {};
+	  scheduler::Workload::Ptr parseWorkload();
+
+	private:
+	  SWFWorkloadFactory (const SWFWorkloadFactory& original);
+	  SWFWorkloadFactory& operator= (const SWFWorkloadFactory& rhs);
+	  std::string _filename;
+  };
+}
+
+#endif /* PAES_SWF_WORKLOAD_FACTORY_HPP */
@@ -0,0 +1,192 @@
+#include "taskpool.hpp"
+#include <iostream>
+#include <cstdlib>
+
+using namespace util;
+
+namespace {
+  struct WorkerArgument {
+	TaskPool* pool;
+	size_t self;
+	unsigned long generation;
+  };
+}
+
+TaskPool& TaskPool::instance() {
+  static TaskPool instance;
+  return instance;
+}
+
+TaskPool::TaskPool () :
+  _ranges(), _threads(), _task(NULL), _generation(0), _busy(0), _stop(false)
+{
+  pthread_mutex_init(&_runMutex, NULL);
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_start, NULL);
+  pthread_cond_init(&_done, NULL);
+  setThreads(1);
+}
+
+TaskPool::~TaskPool() {
+  stop();
+  for (size_t i=0; i < _ranges.size(); i++) {
+	pthread_mutex_destroy(&_ranges[i]->mutex);
+	delete _ranges[i];
+  }
+  pthread_cond_destroy(&_done);
+  pthread_cond_destroy(&_start);
+  pthread_mutex_destroy(&_mutex);
+  pthread_mutex_destroy(&_runMutex);
+}
+
+void TaskPool::setThreads(const unsigned int threads) {
+  stop();
+  for (size_t i=0; i < _ranges.size(); i++) {
+	pthread_mutex_destroy(&_ranges[i]->mutex);
+	delete _ranges[i];
+  }
+  _ranges.clear();
+  for (unsigned int i=0; i < (threads > 0 ? threads : 1); i++) {
+	Range* range=new Range();
+	pthread_mutex_init(&range->mutex, NULL);
+	range->begin=0;
+	range->end=0;
+	_ranges.push_back(range);
+  }
+  for (size_t i=1; i < _ranges.size(); i++) {
+	// the generation is passed on, a thread that starts late must not
+	// miss a run() that began in the meantime
+	WorkerArgument* argument=new WorkerArgument();
+	argument->pool=this;
+	argument->self=i;
+	argument->generation=_generation;
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, workerMain, argument) != 0) {
+	  std::cerr << "Cannot create evaluation thread - aborting." << std::endl;
+	  exit(-1);
+	}
+	_threads.push_back(thread);
+  }
+}
+
+void TaskPool::stop() {
+  pthread_mutex_lock(&_mutex);
+  _stop=true;
+  pthread_cond_broadcast(&_start);
+  pthread_mutex_unlock(&_mutex);
+  for (size_t i=0; i < _threads.size(); i++)
+	pthread_join(_threads[i], NULL);
+  _threads.clear();
+  _stop=false;
+}
+
+void* TaskPool::workerMain(void* argument) {
+  WorkerArgument* worker=static_cast<WorkerArgument*>(argument);
+  TaskPool& pool=*worker->pool;
+  size_t self=worker->self;
+  unsigned long seen=worker->generation;
+  delete worker;
+  pthread_mutex_lock(&pool._mutex);
+  while (true) {
+	while (! pool._stop && pool._generation == seen)
+	  pthread_cond_wait(&pool._start, &pool._mutex);
+	if (pool._stop)
+	  break;
+	seen=pool._generation;
+	pthread_mutex_unlock(&pool._mutex);
+	pool.work(self);
+	pthread_mutex_lock(&pool._mutex);
+	if (--pool._busy == 0)
+	  pthread_cond_signal(&pool._done);
+  }
+  pthread_mutex_unlock(&pool._mutex);
+  return NULL;
+}
+
+bool TaskPool::run(Task& task, const size_t count) {
+  if (_ranges.size() < 2)
+	return false;
+  if (pthread_mutex_trylock(&_runMutex) != 0)
+	return false;
+  size_t threads=_ranges.size();
+  for (size_t i=0; i < threads; i++) {
+	pthread_mutex_lock(&_ranges[i]->mutex);
+	_ranges[i]->begin=count * i / threads;
+	_ranges[i]->end=count * (i + 1) / threads;
+	pthread_mutex_unlock(&_ranges[i]->mutex);
+  }
+  pthread_mutex_lock(&_mutex);
+  _task=&task;
+  _busy=threads - 1;
+  _generation++;
+  pthread_cond_broadcast(&_start);
+  pthread_mutex_unlock(&_mutex);
+  work(0);
+  pthread_mutex_lock(&_mutex);
+  while (_busy > 0)
+	pthread_cond_wait(&_done, &_mutex);
+  _task=NULL;
+  pthread_mutex_unlock(&_mutex);
+  pthread_mutex_unlock(&_runMutex);
+  return true;
+}
+
+void TaskPool::work(const size_t self) {
+  size_t index;
+  while (next(self, index))
+	_task->run(index);
+}
+
+bool TaskPool::next(const size_t self, size_t& index) {
+  Range& own=*_ranges[self];
+  while (true) {
+	pthread_mutex_lock(&own.mutex);
+	if (own.begin < own.end) {
+	  index=own.begin++;
+	  pthread_mutex_unlock(&own.mutex);
+	  return true;
+	}
+	pthread_mutex_unlock(&own.mutex);
+	if (! steal(self))
+	  return false;
+  }
+}
+
+/**
+ * Moves the back half of the fullest other range to the own one.
+ * Returns false if all other ranges are empty.
+ */
+bool TaskPool::steal(const size_t self) {
+  while (true) {
+	size_t victim=self;
+	size_t most=0;
+	for (size_t i=0; i < _ranges.size(); i++) {
+	  if (i == self)
+		continue;
+	  pthread_mutex_lock(&_ranges[i]->mutex);
+	  size_t left=_ranges[i]->end - _ranges[i]->begin;
+	  pthread_mutex_unlock(&_ranges[i]->mutex);
+	  if (left > most) {
+		most=left;
+		victim=i;
+	  }
+	}
+	if (most == 0)
+	  return false;
+	Range& other=*_ranges[victim];
+	pthread_mutex_lock(&other.mutex);
+	size_t left=other.end - other.begin;
+	size_t taken=(left + 1) / 2;
+	size_t begin=other.end - taken;
+	other.end=begin;
+	pthread_mutex_unlock(&other.mutex);
+	if (taken == 0)
+	  continue;
+	Range& own=*_ranges[self];
+	pthread_mutex_lock(&own.mutex);
+	own.begin=begin;
+	own.end=begin + taken;
+	pthread_mutex_unlock(&own.mutex);
+	return true;
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef PAES_TASKPOOL_HPP
+#define PAES_TASKPOOL_HPP 1
+
+#include <common.hpp>
+#include <vector>
+#include <pthread.h>
+
+namespace util {
+  /**
+   * A work-stealing pool for splitting one large operation, e.g. the
+   * evaluation of all queues of a new schedule, over several threads.
+   *
+   * run() splits the task indices into one contiguous range per thread.
+   * Each thread works from the front of its own range. When its range
+   * is empty it steals the back half of the fullest other range. The
+   * calling thread works as well, so a pool of n threads starts n-1.
+   *
+   * instance() returns the process-wide pool, which has one thread until
+   * setThreads() is called. Only one run() is active at a time. run()
+   * returns false at once if the pool has a single thread or another
+   * thread is using it. The caller then does the work itself.
+   */
+  class TaskPool {
+	public:
+	  class Task {
+		public:
+		  virtual ~Task() {};
+		  virtual void run(const size_t index) = 0;
+	  };
+	  static TaskPool& instance();
+	  /**
+	   * Stops the current threads and starts threads-1 new ones. Must not
+	   * be called while the pool is in use.
+	   */
+	  void setThreads(const unsigned int threads);
+	  unsigned int getThreads() const { return _ranges.size(); };
+	  /**
+	   * Runs task.run(index) for all indices below count, each once, and
+	   * returns when all have finished.
+	   */
+	  bool run(Task& task, const size_t count);
+	  ~TaskPool();
+
+	private:
+	  /**
+	   * The indices left to a thread, on a cache line of its own.
+	   */
+	  struct Range {
+		pthread_mutex_t mutex;
+		size_t begin;
+		size_t end;
+		char padding[64];
+	  };
+	  TaskPool ();
+	  TaskPool (const TaskPool& original);
+	  TaskPool& operator= (const TaskPool& rhs);
+	  static void* workerMain(void* argument);
+	  void stop();
+	  void work(const size_t self);
+	  bool next(const size_t self, size_t& index);
+	  bool steal(const size_t self);
+	  std::vector<Range*> _ranges;
+	  std::vector<pthread_t> _threads;
+	  pthread_mutex_t _runMutex;
+	  pthread_mutex_t _mutex;
+	  pthread_cond_t _start;
+	  pthread_cond_t _done;
+	  Task* _task;
+	  unsigned long _generation;
+	  size_t _busy;
+	  bool _stop;
+  };
+}
+
+#endif /* PAES_TASKPOOL_HPP */
@@ -0,0 +1,112 @@
+#include "telemetry.hpp"
+#include <mutex.hpp>
+#include <sstream>
+#include <vector>
+
+using namespace util::telemetry;
+
+namespace {
+#ifdef PAES_TELEMETRY
+  const char* COUNTER_NAMES[NUM_COUNTERS] = {
+	"(1)", "(2)", "(3a)", "(3b)", "ins", "repl", "rej"
+  };
+  const char* PHASE_NAMES[NUM_PHASES] = {
+	"mutate", "propagate", "reschedule", "archive", "location", "report"
+  };
+
+  double percent(const uint64_t part, const uint64_t total) {
+	return total > 0 ? (100.0 * part) / total : 0.0;
+  }
+#endif
+
+  // Registered threads, their values outlive them.
+  util::Mutex& getMutex() {
+	static util::Mutex* mutex=new util::Mutex();
+	return *mutex;
+  }
+  std::vector<ThreadValues*>& getThreads() {
+	static std::vector<ThreadValues*>* threads=new std::vector<ThreadValues*>();
+	return *threads;
+  }
+}
+
+ThreadValues* util::telemetry::registerThread() {
+  ThreadValues* values=new ThreadValues();
+  memset(values, 0, sizeof(ThreadValues));
+  util::ScopedLock lock(getMutex());
+  getThreads().push_back(values);
+  return values;
+}
+
+const Values util::telemetry::getTotals() {
+  Values totals;
+  memset(&totals, 0, sizeof(totals));
+  util::ScopedLock lock(getMutex());
+  std::vector<ThreadValues*>& threads=getThreads();
+  for (size_t t = 0; t < threads.size(); t++) {
+	Values& values=threads[t]->values;
+	for (unsigned int i = 0; i < NUM_COUNTERS; i++)
+	  totals.counts[i] += __atomic_load_n(&values.counts[i], __ATOMIC_RELAXED);
+	for (unsigned int i = 0; i < NUM_PHASES; i++)
+	  totals.nanoseconds[i] += __atomic_load_n(&values.nanoseconds[i], __ATOMIC_RELAXED);
+  }
+  return totals;
+}
+
+const std::string util::telemetry::getColumnHeader() {
+#ifdef PAES_TELEMETRY
+  std::ostringstream oss;
+  for (unsigned int i = 0; i < NUM_COUNTERS; i++)
+	oss << "\t" << COUNTER_NAMES[i];
+  for (unsigned int i = 0; i < NUM_PHASES; i++)
+	oss << "\t" << PHASE_NAMES[i] << "_ms";
+  return oss.str();
+#else
+  return std::string();
+#endif
+}
+
+const std::string util::telemetry::getColumns(const Values& current, const Values& last) {
+#ifdef PAES_TELEMETRY
+  std::ostringstream oss;
+  oss.precision(6);
+  for (unsigned int i = 0; i < NUM_COUNTERS; i++)
+	oss << "\t" << (current.counts[i] - last.counts[i]);
+  for (unsigned int i = 0; i < NUM_PHASES; i++)
+	oss << "\t" << (current.nanoseconds[i] - last.nanoseconds[i]) / 1e6;
+  return oss.str();
+#else
+  (void) current;
+  (void) last;
+  return std::string();
+#endif
+}
+
+const std::string util::telemetry::getSummary(const Values& totals, const double seconds) {
+#ifdef PAES_TELEMETRY
+  std::ostringstream oss;
+  oss.precision(4);
+  uint64_t evaluations=0;
+  for (unsigned int i = BRANCH_1; i <= BRANCH_3B; i++)
+	evaluations += totals.counts[i];
+  double rate = seconds > 0.0 ? 1.0 / seconds : 0.0;
+  oss << "Telemetry: " << evaluations << " evaluations (" << evaluations * rate << "/s), branches";
+  for (unsigned int i = BRANCH_1; i <= BRANCH_3B; i++)
+	oss << " " << COUNTER_NAMES[i] << " " << totals.counts[i] << " (" << percent(totals.counts[i], evaluations) << "%)";
+  oss << std::endl;
+  oss << "Telemetry: archive inserts " << totals.counts[ARCHIVE_INSERT] << " (" << totals.counts[ARCHIVE_INSERT] * rate << "/s)";
+  oss << ", replacements " << totals.counts[ARCHIVE_REPLACE] << " (" << totals.counts[ARCHIVE_REPLACE] * rate << "/s)";
+  oss << ", rejects " << totals.counts[ARCHIVE_REJECT] << " (" << totals.counts[ARCHIVE_REJECT] * rate << "/s)" << std::endl;
+  oss << "Telemetry: seconds summed over all threads (share of wall time) in";
+  for (unsigned int i = 0; i < NUM_PHASES; i++) {
+	double phase=totals.nanoseconds[i] / 1e9;
+	oss << " " << PHASE_NAMES[i] << " " << phase << " (" << (seconds > 0.0 ? 100.0 * phase / seconds : 0.0) << "%)";
+  }
+  oss << std::endl;
+  return oss.str();
+#else
+  (void) totals;
+  (void) seconds;
+  return std::string();
+#endif
+}
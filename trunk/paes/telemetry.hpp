@@ -0,0 +1,132 @@
+#ifndef PAES_TELEMETRY_HPP
+#define PAES_TELEMETRY_HPP 1
+
+#include <common.hpp>
+#include <time.h>
+#include <stdint.h>
+
+/**
+ * Hot-path instrumentation of the optimizer: counters of the PAES
+ * branches and archive outcomes and the time spent in the phases of an
+ * iteration. Built with -DPAES_TELEMETRY (the default, see the
+ * Makefile); without it the macros expand to nothing and the report
+ * functions return empty strings.
+ */
+#ifdef PAES_TELEMETRY
+#define TELEMETRY_COUNT(counter) util::telemetry::count(util::telemetry::counter)
+#define TELEMETRY_TIMER(phase) util::telemetry::ScopedTimer telemetryTimer_##phase(util::telemetry::phase)
+#else
+#define TELEMETRY_COUNT(counter)
+#define TELEMETRY_TIMER(phase)
+#endif
+
+namespace util {
+  namespace telemetry {
+	enum Counter {
+	  BRANCH_1,        // current schedule dominates the mutation
+	  BRANCH_2,        // mutation dominates the current schedule
+	  BRANCH_3A,       // archive dominates the mutation
+	  BRANCH_3B,       // archive test routine
+	  ARCHIVE_INSERT,  // archived, the archive grew or lost dominated schedules
+	  ARCHIVE_REPLACE, // archived in place of a schedule of the most crowded cell
+	  ARCHIVE_REJECT,  // duplicate or dominated, not archived
+	  NUM_COUNTERS
+	};
+	/**
+	 * Phases may nest, the times are inclusive: archive contains the
+	 * location updates it carries out itself (not the ones deferred to
+	 * the end of a batch), mutate the first propagation of a schedule.
+	 */
+	enum Phase {
+	  MUTATE,
+	  PROPAGATE,
+	  RESCHEDULE,
+	  ARCHIVE,
+	  LOCATION,
+	  REPORT,
+	  NUM_PHASES
+	};
+
+	/**
+	 * Totals of all threads.
+	 */
+	struct Values {
+	  uint64_t counts[NUM_COUNTERS];
+	  uint64_t nanoseconds[NUM_PHASES];
+	};
+
+	/**
+	 * The counters of one thread. Only the owning thread writes them,
+	 * other threads read them with atomic loads while summing up.
+	 */
+	struct ThreadValues {
+	  Values values;
+	  unsigned int depth[NUM_PHASES];
+	};
+
+	ThreadValues* registerThread();
+
+	inline ThreadValues& local() {
+	  static __thread ThreadValues* values=NULL;
+	  if (values == NULL)
+		values=registerThread();
+	  return *values;
+	}
+
+	inline void add(uint64_t& target, const uint64_t amount) {
+	  __atomic_store_n(&target, target + amount, __ATOMIC_RELAXED);
+	}
+
+	inline void count(const Counter counter) {
+	  add(local().values.counts[counter], 1);
+	}
+
+	inline uint64_t getNanoseconds() {
+	  struct timespec ts;
+	  clock_gettime(CLOCK_MONOTONIC, &ts);
+	  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
+
+	/**
+	 * Adds its lifetime to the phase, unless the thread is already
+	 * timing the same phase further up the stack.
+	 */
+	class ScopedTimer {
+	  public:
+		ScopedTimer (const Phase phase) :
+		  _values(local()), _phase(phase), _start(0)
+		{
+		  if (_values.depth[_phase]++ == 0)
+			_start=getNanoseconds();
+		};
+		~ScopedTimer() {
+		  if (--_values.depth[_phase] == 0)
+			add(_values.values.nanoseconds[_phase], getNanoseconds() - _start);
+		};
+	  private:
+		ScopedTimer (const ScopedTimer& original);
+		ScopedTimer& operator= (const ScopedTimer& rhs);
+		ThreadValues& _values;
+		Phase _phase;
+		uint64_t _start;
+	};
+
+	/**
+	 * Sums up the values of all threads so far.
+	 */
+	const Values getTotals();
+	/**
+	 * Column names and values for the runtime report, each one
+	 * preceded by a tab. The values are the changes since last, times
+	 * in milliseconds.
+	 */
+	const std::string getColumnHeader();
+	const std::string getColumns(const Values& current, const Values& last);
+	/**
+	 * Summary lines of a run of the given length.
+	 */
+	const std::string getSummary(const Values& totals, const double seconds);
+  }
+}
+
+#endif /* PAES_TELEMETRY_HPP */
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdexcept>
+
+#include <common.hpp>
+#include <workload.hpp>
+#include <workload-factory.hpp>
+#include <swf-workload-factory.hpp>
+#include <binaryworkloadfile.hpp>
+
+void printHelp() {
+  std::cout << "PAES workload converter - writes binary workload files" << std::endl;
+  std::cout << "Mandatory commandline parameters:" << std::endl;
+  std::cout << " -i <FILE>: Specify input file" << std::endl;
+  std::cout << " -o <FILE>: Specify output file" << std::endl;
+  std::cout << "Optional parameters:" << std::endl;
+  std::cout << " -f <text|swf>: Input format (default: swf for *.swf files, text otherwise)" << std::endl;
+}
+
+int main (int argc, char** argv) {
+  char *inputfile = NULL;
+  char *outputfile = NULL;
+  std::string format;
+  int c;
+
+  opterr = 0;
+  while ((c = getopt (argc, argv, "hi:o:f:")) != -1)
+	switch (c) {
+	  case 'h':
+		printHelp();
+		exit(0);
+		break;
+	  case 'i':
+		inputfile = optarg;
+		break;
+	  case 'o':
+		outputfile = optarg;
+		break;
+	  case 'f':
+		format = optarg;
+		break;
+	  case '?':
+		if (optopt == 'i' || optopt == 'o' || optopt == 'f')
+		  fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+		else if (isprint (optopt))
+		  fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+		else
+		  fprintf (stderr,
+			  "Unknown option character `\\x%x'.\n",
+			  optopt);
+		return 1;
+	  default:
+		abort ();
+	}
+
+  if (inputfile == NULL || outputfile == NULL) {
+	printHelp();
+	exit(-1);
+  }
+  if (format.empty()) {
+	std::string name(inputfile);
+	if (name.size() > 4 && name.substr(name.size() - 4) == ".swf")
+	  format = "swf";
+	else
+	  format = "text";
+  }
+
+  scheduler::Workload::Ptr workload;
+  if (format == "swf") {
+	scheduler::SWFWorkloadFactory factory(inputfile);
+	workload=factory.parseWorkload();
+  } else if (format == "text") {
+	scheduler::FileWorkloadFactory factory(inputfile);
+	workload=factory.parseWorkload();
+  } else {
+	std::cerr << "Unknown input format " << format << " - aborting." << std::endl;
+	exit(-1);
+  }
+
+  try {
+	scheduler::BinaryWorkloadFile::write(workload, outputfile);
+  } catch (std::runtime_error& e) {
+	std::cerr << e.what() << " - aborting." << std::endl;
+	exit(-1);
+  }
+  std::cout << "Wrote " << workload->size() << " jobs to " << outputfile << std::endl;
+  return 0;
+}
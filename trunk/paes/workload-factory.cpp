@@ -1,45 +1,72 @@
 #include "workload-factory.hpp"
-#include <fstream>
-#include <sstream>
-#include <string>
+#include <mappedfile.hpp>
+#include <numberscanner.hpp>
+#include <binaryworkloadfile.hpp>
+#include <stdexcept>
+#include <string.h>
 
 
 
 using namespace scheduler;
 
+/**
+ * Binary workload files are used as they are mapped, see
+ * BinaryWorkloadFile. Text files are parsed from the mapping in place. Every line holds the columns
+ * job id, submit time, run time, wall time and size, separated by
+ * blanks; further columns are ignored. Empty lines and lines starting
+ * with '#' are skipped. A malformed line aborts with its line number.
+ */
 scheduler::Workload::Ptr FileWorkloadFactory::parseWorkload() {
   scheduler::Workload::Ptr retval(new scheduler::Workload());
   std::cout << "Loading workload from file " << _filename << std::endl;
-  std::string line;
-  std::ifstream myfile (_filename.c_str());
-  if (myfile.is_open()) {
-	while (! myfile.eof() ) {
-	  getline(myfile,line);
-	  // first, ignore all lines starting with '#'
-	  if (line[0] == '#')
-		continue;
-	  std::istringstream iss(line, std::istringstream::in);
+  util::MappedFile::Ptr file;
+  try {
+	file=util::MappedFile::Ptr(new util::MappedFile(_filename));
+  } catch (std::runtime_error& e) {
+	std::cerr << e.what() << ", aborting" << std::endl; 
+	exit(-1);
+  }
+  if (scheduler::BinaryWorkloadFile::isBinaryWorkload(*file)) {
+	try {
+	  return scheduler::BinaryWorkloadFile::load(file);
+	} catch (std::runtime_error& e) {
+	  std::cerr << _filename << ": " << e.what() << ", aborting" << std::endl;
+	  exit(-1);
+	}
+  }
+  const char* pos=file->begin();
+  const char* end=file->end();
+  size_t lines=0;
+  for (const char* p=pos; p < end && (p=static_cast<const char*>(memchr(p, '\n', end - p))) != NULL; p++)
+	lines++;
+  retval->reserve(lines + 1);
+
+  unsigned long lineNumber=0;
+  while (pos < end) {
+	lineNumber++;
+	const char* eol=static_cast<const char*>(memchr(pos, '\n', end - pos));
+	if (eol == NULL)
+	  eol=end;
+	const char* p=util::scanner::skipBlanks(pos, eol);
+	// ignore empty lines and all lines starting with '#'
+	if (p != eol && *p != '#') {
 	  scheduler::Job::IDType jobid;
-	  iss >> jobid;
 	  double submit_time;
-	  iss >> submit_time;
 	  double run_time;
-	  iss >> run_time;
 	  double wall_time;
-	  iss >> wall_time;
 	  unsigned int size;
-	  iss >> size;
-	  scheduler::Job::Ptr job(new scheduler::Job(jobid, submit_time, run_time, wall_time, size));
-	  if (!myfile.eof()) { 
-		// check for eof again - otherwise, we might duplicate the last job again,
-		retval->add(job);
-		//std::cout << job->str() << std::endl;
+	  if (! (util::scanner::scanUnsigned(p, eol, jobid) &&
+			util::scanner::scanDouble(p, eol, submit_time) &&
+			util::scanner::scanDouble(p, eol, run_time) &&
+			util::scanner::scanDouble(p, eol, wall_time) &&
+			util::scanner::scanIntegral(p, eol, size))) {
+		std::cerr << _filename << ":" << lineNumber << ": malformed line, expected ";
+		std::cerr << "<job id> <submit time> <run time> <wall time> <size> - aborting." << std::endl;
+		exit(-1);
 	  }
+	  retval->add(jobid, submit_time, run_time, wall_time, size);
 	}
-	myfile.close();
-  } else {
-	std::cerr << "Unable to open file, aborting" << std::endl; 
-	exit(-1);
+	pos=eol + 1;
   }
   return retval;
 }
@@ -1,67 +1,136 @@
 #include "workload.hpp"
 #include <random.hpp>
 #include <sstream>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace scheduler;
 
 const std::string Workload::str() {
   std::ostringstream oss;
-  oss << "Workload of " << _jobs.size() <<" jobs:" << std::endl;
-  JobIteratorType it;
-  for (it=_jobs.begin(); it != _jobs.end(); it++) {
-	oss << (*it).second->str() << std::endl;
+  oss << "Workload of " << _size <<" jobs:" << std::endl;
+  for (IndexType i=0; i < _size; i++) {
+	Job job(getJobID(i), getSubmitTime(i), getRunTime(i), getWallTime(i), getSize(i));
+	oss << job.str() << std::endl;
   }
   return oss.str();
 }
 
+void Workload::reserve(const size_t jobs) {
+  detach();
+  _jobIDs.reserve(jobs);
+  _submitTimes.reserve(jobs);
+  _runTimes.reserve(jobs);
+  _wallTimes.reserve(jobs);
+  _sizes.reserve(jobs);
+  updateColumns();
+}
+
+void Workload::detach() {
+  if (! _mapping)
+	return;
+  _jobIDs.assign(_jobIDColumn, _jobIDColumn + _size);
+  _submitTimes.assign(_submitTimeColumn, _submitTimeColumn + _size);
+  _runTimes.assign(_runTimeColumn, _runTimeColumn + _size);
+  _wallTimes.assign(_wallTimeColumn, _wallTimeColumn + _size);
+  _sizes.assign(_sizeColumn, _sizeColumn + _size);
+  _mapping.reset();
+  updateColumns();
+}
+
+void Workload::updateColumns() {
+  _size=_jobIDs.size();
+  if (_size == 0) {
+	_jobIDColumn=NULL;
+	_submitTimeColumn=_runTimeColumn=_wallTimeColumn=NULL;
+	_sizeColumn=NULL;
+	return;
+  }
+  _jobIDColumn=&_jobIDs[0];
+  _submitTimeColumn=&_submitTimes[0];
+  _runTimeColumn=&_runTimes[0];
+  _wallTimeColumn=&_wallTimes[0];
+  _sizeColumn=&_sizes[0];
+}
+
 void Workload::add(scheduler::Job::Ptr job) {
-  Job::IDType currentID(job->getJobID());
-  _jobs[currentID]=job;
-  //if (currentID < _minResourceID) 
-  //  _minResourceID = currentID;
-  //if (currentID > _maxResourceID)
-  //  _maxResourceID = currentID;
+  add(job->getJobID(), job->getSubmitTime(), job->getRunTime(),
+	  job->getWallTime(), job->getSize());
+}
 
-  //_jobs.push_back(job);
+/**
+ * Appends the job to the columns. Jobs are expected in increasing id
+ * order - others are inserted at their sorted position, a job with an
+ * already known id replaces the old one.
+ */
+void Workload::add(scheduler::Job::IDType jobid, double submit_time, double run_time,
+	double wall_time, unsigned int size) {
+  detach();
+  if (_jobIDs.empty() || jobid > _jobIDs.back()) {
+	_jobIDs.push_back(jobid);
+	_submitTimes.push_back(submit_time);
+	_runTimes.push_back(run_time);
+	_wallTimes.push_back(wall_time);
+	_sizes.push_back(size);
+	updateColumns();
+	return;
+  }
+  std::vector<scheduler::Job::IDType>::iterator it=
+	std::lower_bound(_jobIDs.begin(), _jobIDs.end(), jobid);
+  size_t index = it - _jobIDs.begin();
+  if ((*it) != jobid) {
+	_jobIDs.insert(it, jobid);
+	_submitTimes.insert(_submitTimes.begin() + index, submit_time);
+	_runTimes.insert(_runTimes.begin() + index, run_time);
+	_wallTimes.insert(_wallTimes.begin() + index, wall_time);
+	_sizes.insert(_sizes.begin() + index, size);
+  } else {
+	_submitTimes[index]=submit_time;
+	_runTimes[index]=run_time;
+	_wallTimes[index]=wall_time;
+	_sizes[index]=size;
+  }
+  updateColumns();
 }
 
-// TODO: Implement caching of the value
 const scheduler::Job::IDType Workload::getMinJobID() {
-  scheduler::Job::IDType retval = scheduler::Job::JOBID_MAX;
-  JobIteratorType it;
-  for (it=_jobs.begin(); it != _jobs.end(); it++) {
-	if ((*it).second->getJobID() < retval)
-	  retval=((*it).second->getJobID());
-  }
-  return retval;
+  if (_size == 0)
+	return scheduler::Job::JOBID_MAX;
+  return _jobIDColumn[0];
 }
 
-// TODO: Implement caching of the value
 const scheduler::Job::IDType Workload::getMaxJobID() {
-  scheduler::Job::IDType retval = 0;
-  JobIteratorType it;
-  for (it=_jobs.begin(); it != _jobs.end(); it++) {
-	if ((*it).second->getJobID() > retval)
-	  retval=((*it).second->getJobID());
-  }
-  return retval;
+  if (_size == 0)
+	return 0;
+  return _jobIDColumn[_size - 1];
 }
 
 const scheduler::Job::IDType Workload::getRandomJobID() {
   util::RNG& rng=util::RNG::instance();
   return rng.uniform_derivate_ranged_int(getMinJobID(), getMaxJobID());
 }
- 
+
 scheduler::Job::Ptr Workload::getJobByID(const scheduler::Job::IDType& id) {
-  Job::Ptr retval(_jobs[id]);
+  const scheduler::Job::IDType* end=_jobIDColumn + _size;
+  const scheduler::Job::IDType* it=std::lower_bound(_jobIDColumn, end, id);
+  if (it == end || (*it) != id)
+	return Job::Ptr();
+  IndexType i = it - _jobIDColumn;
+  Job::Ptr retval(new Job(getJobID(i), getSubmitTime(i), getRunTime(i), getWallTime(i), getSize(i)));
   return retval;
 }
 
-std::vector<scheduler::Job::IDType> Workload::getJobIDs() {
-  std::vector<scheduler::Job::IDType> retval;
-  JobIteratorType it;
-  for (it=_jobs.begin(); it != _jobs.end(); it++) {
-	retval.push_back((*it).second->getJobID());
+Workload::IndexType Workload::getJobIndex(const scheduler::Job::IDType& id) const {
+  const scheduler::Job::IDType* end=_jobIDColumn + _size;
+  const scheduler::Job::IDType* it=std::lower_bound(_jobIDColumn, end, id);
+  if (it == end || (*it) != id) {
+	std::ostringstream oss;
+	oss << "Workload: no job with id " << id;
+	throw std::out_of_range(oss.str());
   }
-  return retval;
+  return it - _jobIDColumn;
+}
+
+std::vector<scheduler::Job::IDType> Workload::getJobIDs() {
+  return std::vector<scheduler::Job::IDType>(_jobIDColumn, _jobIDColumn + _size);
 }
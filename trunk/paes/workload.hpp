@@ -2,33 +2,100 @@
 #define PAES_WORKLOAD_HPP 1
 #include <common.hpp>
 #include <job.hpp>
-#include <map>
+#include <mappedfile.hpp>
 #include <vector>
 
 namespace scheduler	{
+  /**
+   * Stores the jobs as dense columns. A job is addressed by its index,
+   * indices follow the job id order. Job ids are only needed to map
+   * the input to indices and for reporting.
+   *
+   * The columns are either owned by the workload or point into a
+   * memory mapped binary workload file (see BinaryWorkloadFile). A
+   * mapped workload is copied into owned columns on the first add().
+   */
   class Workload {
 	public:
-	  typedef std::map<scheduler::Job::IDType, scheduler::Job::Ptr>::iterator JobIteratorType;
 	  typedef std::tr1::shared_ptr<Workload> Ptr;
-	  Workload () : _jobs() {};
+	  typedef unsigned int IndexType;
+	  Workload () : _jobIDs(), _submitTimes(), _runTimes(), _wallTimes(), _sizes(),
+		_mapping(), _size(0), _jobIDColumn(NULL), _submitTimeColumn(NULL),
+		_runTimeColumn(NULL), _wallTimeColumn(NULL), _sizeColumn(NULL) {};
+	  /**
+	   * Uses the given columns of a mapped file, which must hold jobs
+	   * sorted by strictly increasing id.
+	   */
+	  Workload (const util::MappedFile::Ptr& mapping, const size_t jobs,
+		  const scheduler::Job::IDType* jobIDs, const double* submitTimes,
+		  const double* runTimes, const double* wallTimes, const unsigned int* sizes) :
+		_jobIDs(), _submitTimes(), _runTimes(), _wallTimes(), _sizes(),
+		_mapping(mapping), _size(jobs), _jobIDColumn(jobIDs), _submitTimeColumn(submitTimes),
+		_runTimeColumn(runTimes), _wallTimeColumn(wallTimes), _sizeColumn(sizes) {};
 	  virtual ~Workload() {};
 	  void add(scheduler::Job::Ptr job);
+	  void add(scheduler::Job::IDType jobid, double submit_time, double run_time,
+		  double wall_time, unsigned int size);
 	  const scheduler::Job::IDType getMinJobID();
 	  const scheduler::Job::IDType getMaxJobID();
 	  const scheduler::Job::IDType getRandomJobID();
 	  std::vector<scheduler::Job::IDType> getJobIDs();
-	  const size_t size() { return _jobs.size(); };
+	  size_t size() const { return _size; };
+	  /**
+	   * Reserves space for the given number of jobs.
+	   */
+	  void reserve(const size_t jobs);
 	  const std::string str();
 
+	  /**
+	   * Returns the job with the given id, or an empty pointer if there
+	   * is no such job. The job is built from the columns on each call.
+	   */
 	  scheduler::Job::Ptr getJobByID(const scheduler::Job::IDType& id);
+	  /**
+	   * Returns the index of the job with the given id. Throws
+	   * std::out_of_range if there is no such job.
+	   */
+	  IndexType getJobIndex(const scheduler::Job::IDType& id) const;
+
+	  scheduler::Job::IDType getJobID(const IndexType& index) const { return _jobIDColumn[index]; };
+	  double getSubmitTime(const IndexType& index) const { return _submitTimeColumn[index]; };
+	  double getRunTime(const IndexType& index) const { return _runTimeColumn[index]; };
+	  double getWallTime(const IndexType& index) const { return _wallTimeColumn[index]; };
+	  unsigned int getSize(const IndexType& index) const { return _sizeColumn[index]; };
+	  /**
+	   * Direct access to the columns, e.g. to write them to a file.
+	   */
+	  const scheduler::Job::IDType* getJobIDColumn() const { return _jobIDColumn; };
+	  const double* getSubmitTimeColumn() const { return _submitTimeColumn; };
+	  const double* getRunTimeColumn() const { return _runTimeColumn; };
+	  const double* getWallTimeColumn() const { return _wallTimeColumn; };
+	  const unsigned int* getSizeColumn() const { return _sizeColumn; };
 
 	private:
 	  Workload (const Workload& original);
 	  Workload& operator= (const Workload& rhs);
-	  std::map<scheduler::Job::IDType, scheduler::Job::Ptr> _jobs;
-	  
+	  /**
+	   * Copies mapped columns into the owned ones.
+	   */
+	  void detach();
+	  /**
+	   * Points the columns to the owned vectors.
+	   */
+	  void updateColumns();
+	  std::vector<scheduler::Job::IDType> _jobIDs;
+	  std::vector<double> _submitTimes;
+	  std::vector<double> _runTimes;
+	  std::vector<double> _wallTimes;
+	  std::vector<unsigned int> _sizes;
+	  util::MappedFile::Ptr _mapping;
+	  size_t _size;
+	  const scheduler::Job::IDType* _jobIDColumn;
+	  const double* _submitTimeColumn;
+	  const double* _runTimeColumn;
+	  const double* _wallTimeColumn;
+	  const unsigned int* _sizeColumn;
   };
 }
 
 #endif /* PAES_WORKLOAD_HPP */
-
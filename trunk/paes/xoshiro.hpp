@@ -0,0 +1,82 @@
+#ifndef PAES_XOSHIRO_HPP
+#define PAES_XOSHIRO_HPP 1
+
+#include <stdint.h>
+
+namespace util {
+  /**
+   * The xoshiro256** generator by Blackman and Vigna, see
+   * http://prng.di.unimi.it/. 256 bits of state, period 2^256-1 and
+   * no locking. The state is initialized from a 64 bit seed with
+   * splitmix64. jump() advances the generator by 2^128 steps, so
+   * generators with the same seed that are jumped a different number
+   * of times produce independent streams.
+   */
+  class Xoshiro256 {
+	public:
+	  typedef uint64_t ResultType;
+	  Xoshiro256 (const uint64_t seed) { setSeed(seed); };
+	  virtual ~Xoshiro256() {};
+
+	  void setSeed(uint64_t seed) {
+		for (unsigned int i = 0; i < 4; i++) {
+		  // splitmix64
+		  seed += 0x9e3779b97f4a7c15ULL;
+		  uint64_t z = seed;
+		  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		  _s[i] = z ^ (z >> 31);
+		}
+	  };
+
+	  ResultType next() {
+		const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+		const uint64_t t = _s[1] << 17;
+		_s[2] ^= _s[0];
+		_s[3] ^= _s[1];
+		_s[1] ^= _s[2];
+		_s[0] ^= _s[3];
+		_s[2] ^= t;
+		_s[3] = rotl(_s[3], 45);
+		return result;
+	  };
+
+	  void jump() {
+		static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+		  0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+		uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		for (unsigned int i = 0; i < 4; i++) {
+		  for (unsigned int b = 0; b < 64; b++) {
+			if (JUMP[i] & (((uint64_t)1) << b)) {
+			  s0 ^= _s[0];
+			  s1 ^= _s[1];
+			  s2 ^= _s[2];
+			  s3 ^= _s[3];
+			}
+			next();
+		  }
+		}
+		_s[0] = s0;
+		_s[1] = s1;
+		_s[2] = s2;
+		_s[3] = s3;
+	  };
+
+	  /**
+	   * Access to the raw state, e.g. for checkpoints.
+	   */
+	  const uint64_t* getState() const { return _s; };
+	  void setState(const uint64_t* state) {
+		for (unsigned int i = 0; i < 4; i++)
+		  _s[i] = state[i];
+	  };
+
+	private:
+	  static uint64_t rotl(const uint64_t x, const int k) {
+		return (x << k) | (x >> (64 - k));
+	  };
+	  uint64_t _s[4];
+  };
+}
+
+#endif /* PAES_XOSHIRO_HPP */